@@ -0,0 +1,276 @@
+#include "t5577_detect.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SCORE_MAX 1000
+
+// Only 125 kHz captures are scored. PSK captures are taken at 62.5 kHz with a 25% duty cycle, which
+// drives the tag through the second harmonic, so the timer sees something this model doesn't cover.
+#define FREQUENCY_TOLERANCE 0.01f
+
+#define FSK_LOW_CYCLES  5 // RF/5, FSK1 and FSK1a
+#define FSK_MID_CYCLES  8 // RF/8, all FSK modes
+#define FSK_HIGH_CYCLES 10 // RF/10, FSK2 and FSK2a
+
+// PSK1, PSK2 and PSK3 only differ in how data maps to phase shifts. The sub-carrier comes from the
+// PSKCF bits, which block 0 leaves at 0 (RF/2) for every PSK mode.
+#define PSK_CARRIER_CYCLES 2
+
+#define RUN_MULTIPLES     4 // Runs of up to this many bits are scored
+#define PSK_RUN_MULTIPLES 8 // PSK3 runs start at two bits, longer ones tell T from 2T
+#define USED_SHARE        50 // A multiple counts as seen once it holds 1/USED_SHARE of the capture
+
+// How close a run has to be to a multiple of the bit length, as a fraction of the bit. FSK runs
+// are only known to within a sub-carrier period, so they need a quarter bit. PSK runs are exact
+// to a carrier cycle, and a quarter bit at long runs would also take in the run lengths next to it.
+#define FIT_LOOSE 4
+#define FIT_TIGHT 8
+
+typedef enum {
+    FskClassNone,
+    FskClassLow,
+    FskClassMid,
+    FskClassHigh,
+} FskClass;
+
+// Every histogram is weighted by time (a bin gets its own length added, not 1),
+// so a few glitches can't outweigh the real signal.
+struct T5577Detect {
+    uint32_t segments[T5577_DETECT_MAX_CYCLES]; // High and low times
+    uint32_t periods[T5577_DETECT_MAX_CYCLES]; // Rising edge to rising edge
+    uint32_t fsk_runs[T5577_DETECT_MAX_CYCLES]; // Time spent on one FSK frequency
+    uint32_t psk_runs[T5577_DETECT_MAX_CYCLES]; // Time between phase shifts
+    uint32_t segments_total;
+    uint32_t periods_total;
+    uint32_t fsk_runs_total;
+    uint32_t psk_runs_total;
+
+    FskClass fsk_class;
+    uint32_t fsk_run;
+    uint32_t psk_run;
+
+    uint32_t rf_cycle_ns; // One carrier period
+    bool supported; // The capture's frequency can be scored
+};
+
+static uint32_t t5577_detect_cycles(T5577Detect* detect, uint32_t us) {
+    return (uint32_t)(((uint64_t)us * 1000 + detect->rf_cycle_ns / 2) / detect->rf_cycle_ns);
+}
+
+static void t5577_detect_add(uint32_t* hist, uint32_t* total, uint32_t cycles) {
+    if(cycles == 0 || cycles >= T5577_DETECT_MAX_CYCLES) return;
+    hist[cycles] += cycles;
+    *total += cycles;
+}
+
+// Sub-carrier periods are only a few cycles long, so they are matched in microseconds to within
+// 1/divisor of a period. FSK periods are close together and need an eighth. A PSK phase shift is
+// half a period off, so a quarter still never matches one and leaves room for jitter.
+static bool
+    t5577_detect_near(T5577Detect* detect, uint32_t us, uint32_t cycles, uint32_t divisor) {
+    uint32_t center = cycles * detect->rf_cycle_ns / 1000;
+    uint32_t tolerance = center / divisor > 2 ? center / divisor : 2;
+    return us + tolerance >= center && us <= center + tolerance;
+}
+
+T5577Detect* t5577_detect_alloc(void) {
+    T5577Detect* detect = malloc(sizeof(T5577Detect));
+    t5577_detect_reset(detect, T5577_DETECT_FREQUENCY);
+    return detect;
+}
+
+void t5577_detect_free(T5577Detect* detect) {
+    free(detect);
+}
+
+bool t5577_detect_reset(T5577Detect* detect, float frequency) {
+    memset(detect, 0, sizeof(T5577Detect));
+    detect->supported = frequency >= T5577_DETECT_FREQUENCY * (1 - FREQUENCY_TOLERANCE) &&
+                        frequency <= T5577_DETECT_FREQUENCY * (1 + FREQUENCY_TOLERANCE);
+    // Nothing is fed to an unsupported capture, the cycle only has to be valid
+    if(!detect->supported) frequency = T5577_DETECT_FREQUENCY;
+    detect->rf_cycle_ns = (uint32_t)(1000000000.0f / frequency + 0.5f);
+    return detect->supported;
+}
+
+void t5577_detect_feed(T5577Detect* detect, uint32_t duration, uint32_t pulse) {
+    if(!detect->supported || pulse > duration) return;
+    uint32_t period = t5577_detect_cycles(detect, duration);
+    t5577_detect_add(
+        detect->segments, &detect->segments_total, t5577_detect_cycles(detect, pulse));
+    t5577_detect_add(
+        detect->segments,
+        &detect->segments_total,
+        t5577_detect_cycles(detect, duration - pulse));
+    t5577_detect_add(detect->periods, &detect->periods_total, period);
+
+    // FSK: a run ends when the sub-carrier frequency changes
+    FskClass fsk_class = FskClassNone;
+    if(t5577_detect_near(detect, duration, FSK_LOW_CYCLES, 8)) {
+        fsk_class = FskClassLow;
+    } else if(t5577_detect_near(detect, duration, FSK_MID_CYCLES, 8)) {
+        fsk_class = FskClassMid;
+    } else if(t5577_detect_near(detect, duration, FSK_HIGH_CYCLES, 8)) {
+        fsk_class = FskClassHigh;
+    }
+    if(fsk_class != FskClassNone && fsk_class != detect->fsk_class) {
+        t5577_detect_add(detect->fsk_runs, &detect->fsk_runs_total, detect->fsk_run);
+        detect->fsk_class = fsk_class;
+        detect->fsk_run = 0;
+    }
+    detect->fsk_run += period;
+
+    // PSK: a run ends on any period that isn't a whole sub-carrier period
+    detect->psk_run += period;
+    if(!t5577_detect_near(detect, duration, PSK_CARRIER_CYCLES, 4)) {
+        t5577_detect_add(detect->psk_runs, &detect->psk_runs_total, detect->psk_run);
+        detect->psk_run = 0;
+    }
+}
+
+/**
+ * @brief      Score how well a histogram fits whole multiples of a unit.
+ * @details    Every multiple from the first one that shows up to last is expected to show up.
+ *           Multiples that never do scale the score down, which keeps a clock from matching its
+ *           own harmonics.  Missing multiples below the first one don't count: PSK3 only shifts
+ *           on a rising data edge, so its runs are never shorter than two bits.
+ * @param      hist   The histogram.
+ * @param      total  The sum of the histogram.
+ * @param      unit   The unit, in RF cycles.
+ * @param      first  The smallest multiple that counts.
+ * @param      last      The largest multiple that counts.
+ * @param      divisor  A multiple matches within unit/divisor.
+ * @return     The share of the histogram that matches a multiple, 0-SCORE_MAX.
+*/
+static uint32_t t5577_detect_fit(
+    const uint32_t* hist,
+    uint32_t total,
+    uint32_t unit,
+    uint8_t first,
+    uint8_t last,
+    uint8_t divisor) {
+    if(total == 0 || unit == 0) return 0;
+    uint32_t tolerance = unit / divisor ? unit / divisor : 1;
+    uint64_t hits = 0;
+    uint8_t expected = 0;
+    uint8_t used = 0;
+    for(uint32_t k = first; k <= last; k++) {
+        uint32_t center = k * unit;
+        if(center - tolerance >= T5577_DETECT_MAX_CYCLES) break;
+        uint32_t end = center + tolerance;
+        if(end >= T5577_DETECT_MAX_CYCLES) end = T5577_DETECT_MAX_CYCLES - 1;
+        uint64_t window = 0;
+        for(uint32_t c = center - tolerance; c <= end; c++) {
+            window += hist[c];
+        }
+        if(window * USED_SHARE >= total) used++;
+        if(used) expected++;
+        hits += window;
+    }
+    if(expected == 0) return 0;
+    return (uint32_t)(hits * SCORE_MAX / total * used / expected);
+}
+
+// Share of the histogram within one cycle of a sub-carrier period, 0-SCORE_MAX.
+static uint32_t t5577_detect_share(const uint32_t* hist, uint32_t total, uint32_t cycles) {
+    if(total == 0) return 0;
+    uint64_t hits = hist[cycles - 1] + hist[cycles] + hist[cycles + 1];
+    return (uint32_t)(hits * SCORE_MAX / total);
+}
+
+/**
+ * @brief      Score one modulation before looking at the clock.
+ * @details    This is an upper bound of every clock score for the modulation, so modulations that
+ *           can't beat the best match so far are skipped without scoring their clocks.
+*/
+static uint32_t t5577_detect_carrier_score(T5577Detect* detect, uint32_t mod_page_zero) {
+    uint32_t low, mid, high;
+    switch(mod_page_zero) {
+    case LFRFID_T5577_MODULATION_FSK1:
+    case LFRFID_T5577_MODULATION_FSK1a:
+        low = t5577_detect_share(detect->periods, detect->periods_total, FSK_LOW_CYCLES);
+        mid = t5577_detect_share(detect->periods, detect->periods_total, FSK_MID_CYCLES);
+        return low + mid;
+    case LFRFID_T5577_MODULATION_FSK2:
+    case LFRFID_T5577_MODULATION_FSK2a:
+        mid = t5577_detect_share(detect->periods, detect->periods_total, FSK_MID_CYCLES);
+        high = t5577_detect_share(detect->periods, detect->periods_total, FSK_HIGH_CYCLES);
+        return mid + high;
+    case LFRFID_T5577_MODULATION_PSK1:
+    case LFRFID_T5577_MODULATION_PSK2:
+    case LFRFID_T5577_MODULATION_PSK3:
+        return t5577_detect_share(detect->periods, detect->periods_total, PSK_CARRIER_CYCLES);
+    default:
+        return SCORE_MAX; // ASK has no sub-carrier to check
+    }
+}
+
+static uint32_t
+    t5577_detect_clock_score(T5577Detect* detect, uint32_t mod_page_zero, uint32_t clock) {
+    switch(mod_page_zero) {
+    case LFRFID_T5577_MODULATION_DIRECT:
+        // NRZ: every high or low lasts whole bits, so a period is at least two bits
+        return t5577_detect_fit(
+                   detect->segments, detect->segments_total, clock, 1, RUN_MULTIPLES, FIT_LOOSE) *
+               t5577_detect_fit(
+                   detect->periods,
+                   detect->periods_total,
+                   clock,
+                   2,
+                   RUN_MULTIPLES + 1,
+                   FIT_LOOSE) /
+               SCORE_MAX;
+    case LFRFID_T5577_MODULATION_FSK1:
+    case LFRFID_T5577_MODULATION_FSK1a:
+    case LFRFID_T5577_MODULATION_FSK2:
+    case LFRFID_T5577_MODULATION_FSK2a:
+        return t5577_detect_fit(
+            detect->fsk_runs, detect->fsk_runs_total, clock, 1, RUN_MULTIPLES, FIT_LOOSE);
+    case LFRFID_T5577_MODULATION_PSK1:
+    case LFRFID_T5577_MODULATION_PSK2:
+    case LFRFID_T5577_MODULATION_PSK3:
+        return t5577_detect_fit(
+            detect->psk_runs, detect->psk_runs_total, clock, 1, PSK_RUN_MULTIPLES, FIT_TIGHT);
+    default:
+        // Manchester, biphase and diphase: half or whole bits, periods of one to two bits
+        return t5577_detect_fit(
+                   detect->segments, detect->segments_total, clock / 2, 1, 2, FIT_LOOSE) *
+               t5577_detect_fit(
+                   detect->periods, detect->periods_total, clock / 2, 2, 4, FIT_LOOSE) /
+               SCORE_MAX;
+    }
+}
+
+bool t5577_detect_result(T5577Detect* detect, T5577DetectResult* result) {
+    if(detect->periods_total == 0) return false;
+    // Flush the runs still in progress
+    t5577_detect_add(detect->fsk_runs, &detect->fsk_runs_total, detect->fsk_run);
+    detect->fsk_run = 0;
+    t5577_detect_add(detect->psk_runs, &detect->psk_runs_total, detect->psk_run);
+    detect->psk_run = 0;
+
+    // Ties keep the earlier entry of all_mods. The envelope alone can't tell FSK1 from FSK1a,
+    // FSK2 from FSK2a, PSK1 from PSK2 and PSK3, or Manchester from biphase and diphase, so those
+    // tie on purpose.
+    uint32_t best = 0;
+    memset(result, 0, sizeof(T5577DetectResult));
+    for(uint8_t m = 0; m < MODULATION_NUM; m++) {
+        uint32_t carrier = t5577_detect_carrier_score(detect, all_mods[m].mod_page_zero);
+        if(carrier > SCORE_MAX) carrier = SCORE_MAX;
+        if(carrier <= best) continue;
+        for(uint8_t c = 0; c < CLOCK_NUM; c++) {
+            uint32_t score = carrier *
+                             t5577_detect_clock_score(
+                                 detect, all_mods[m].mod_page_zero, all_rf_clocks[c].rf_clock_num) /
+                             SCORE_MAX;
+            if(score > best) {
+                best = score;
+                result->modulation_index = m;
+                result->rf_clock_index = c;
+            }
+        }
+    }
+    result->confidence = best * 100 / SCORE_MAX;
+    return best > 0;
+}
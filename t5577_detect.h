@@ -0,0 +1,37 @@
+#ifndef T5577_DETECT_H
+#define T5577_DETECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <t5577_config.h>
+
+// Longest interval kept in the histograms, in RF cycles: four RF/128 bits plus a quarter bit.
+// Longer intervals are left out.
+#define T5577_DETECT_MAX_CYCLES 544
+
+// The only excitation frequency captures are scored at, in Hz
+#define T5577_DETECT_FREQUENCY 125000.0f
+
+typedef struct T5577Detect T5577Detect;
+
+typedef struct {
+    uint8_t modulation_index; // Index into all_mods
+    uint8_t rf_clock_index; // Index into all_rf_clocks
+    uint8_t confidence; // Share of the capture explained by the match, 0-100
+} T5577DetectResult;
+
+T5577Detect* t5577_detect_alloc(void);
+
+void t5577_detect_free(T5577Detect* detect);
+
+// Start over for a capture taken at this excitation frequency, from the raw file header.
+// Returns false if captures at that frequency can't be scored, everything fed is then ignored.
+bool t5577_detect_reset(T5577Detect* detect, float frequency);
+
+// Feed one captured period: the time between rising edges and the high time, in microseconds.
+void t5577_detect_feed(T5577Detect* detect, uint32_t duration, uint32_t pulse);
+
+// Score every modulation and RF clock against what was fed. Returns false if nothing was fed.
+bool t5577_detect_result(T5577Detect* detect, T5577DetectResult* result);
+
+#endif // T5577_DETECT_H
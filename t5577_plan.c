@@ -0,0 +1,139 @@
+#include "t5577_plan.h"
+
+#include <string.h>
+
+#define T5577_OPCODE_PAGE_0 0b10
+#define T5577_OPCODE_PAGE_1 0b11
+
+static void t5577_plan_push_bit(T5577PlanCommand* command, bool value) {
+    if(value) command->bits[command->bit_count / 8] |= 0x80 >> (command->bit_count % 8);
+    command->bit_count++;
+}
+
+static void t5577_plan_push_bits(T5577PlanCommand* command, uint32_t value, uint8_t count) {
+    for(uint8_t i = 0; i < count; i++) {
+        t5577_plan_push_bit(command, (value >> (count - 1 - i)) & 1);
+    }
+}
+
+static uint32_t t5577_plan_bit_time(bool value) {
+    return (value ? T5577_TIMING_DATA_1 : T5577_TIMING_DATA_0) + T5577_TIMING_WRITE_GAP;
+}
+
+// The reset that ends every block write and the whole session: start gap, then 1 and 0,
+// as in the firmware's t5577_write_reset
+static uint32_t t5577_plan_reset_time(void) {
+    return T5577_TIMING_START_GAP + t5577_plan_bit_time(true) + t5577_plan_bit_time(false);
+}
+
+void t5577_plan_clear(T5577Plan* plan) {
+    memset(plan, 0, sizeof(T5577Plan));
+    plan->air_time_us = t5577_plan_reset_time() * T5577_PLAN_RF_CYCLE_US;
+}
+
+bool t5577_plan_add_block(
+    T5577Plan* plan,
+    uint8_t page,
+    uint8_t block,
+    uint32_t data,
+    bool lock,
+    bool with_pass,
+    uint32_t password) {
+    if(plan->command_count >= T5577_PLAN_MAX_COMMANDS) return false;
+    T5577PlanCommand* command = &plan->commands[plan->command_count++];
+    memset(command, 0, sizeof(T5577PlanCommand));
+    t5577_plan_push_bits(command, (page == 1) ? T5577_OPCODE_PAGE_1 : T5577_OPCODE_PAGE_0, 2);
+    if(with_pass) t5577_plan_push_bits(command, password, 32);
+    t5577_plan_push_bit(command, lock);
+    t5577_plan_push_bits(command, data, 32);
+    t5577_plan_push_bits(command, block, 3);
+    plan->air_time_us += t5577_plan_command_air_time_us(command);
+    return true;
+}
+
+uint32_t t5577_plan_command_air_time_us(const T5577PlanCommand* command) {
+    uint32_t cycles = T5577_TIMING_WAIT_TIME + T5577_TIMING_START_GAP;
+    for(uint8_t i = 0; i < command->bit_count; i++) {
+        cycles += t5577_plan_bit_time(t5577_plan_bit(command, i));
+    }
+    cycles += T5577_TIMING_PROGRAM + T5577_TIMING_WAIT_TIME + t5577_plan_reset_time();
+    return cycles * T5577_PLAN_RF_CYCLE_US;
+}
+
+// One block the plan writes, and the lock_mask bit that locks it
+typedef struct {
+    uint8_t page;
+    uint8_t block;
+    uint32_t data;
+    uint16_t lock; // 0 for block 0, which is never locked
+} T5577PlanWrite;
+
+static uint8_t t5577_plan_writes(const T5577PlanTag* tag, T5577PlanWrite* writes) {
+    uint8_t count = 0;
+    for(uint8_t i = 1; i <= tag->user_block_num && i < LFRFID_T5577_BLOCK_COUNT; i++) {
+        if(tag->use_password && i == T5577_PLAN_PASSWORD_BLOCK) break;
+        writes[count++] = (T5577PlanWrite){0, i, tag->content[i], 1 << i};
+    }
+    if(tag->write_page_1) {
+        for(uint8_t i = 1; i < T5577_PLAN_PAGE_1_BLOCK_COUNT; i++) {
+            uint8_t lock_bit = LFRFID_T5577_BLOCK_COUNT + i - 1;
+            writes[count++] = (T5577PlanWrite){1, i, tag->page_1[i], 1 << lock_bit};
+        }
+    }
+    if(tag->use_password) {
+        writes[count++] = (T5577PlanWrite){
+            0, T5577_PLAN_PASSWORD_BLOCK, tag->password, 1 << T5577_PLAN_PASSWORD_BLOCK};
+    }
+    writes[count++] = (T5577PlanWrite){0, 0, tag->block_zero, 0};
+    return count;
+}
+
+static void t5577_plan_add_write(
+    T5577Plan* plan,
+    const T5577PlanTag* tag,
+    const T5577PlanWrite* write,
+    bool lock) {
+    t5577_plan_add_block(
+        plan, write->page, write->block, write->data, lock, tag->use_password, tag->password);
+}
+
+/**
+ * @brief      Encode every write the tag needs.
+ * @details    The data blocks go first, then page 1, then the password, and block 0 last: a config
+ *           or password that lands early would change how the tag takes the rest of the session.
+ *           With a password every write carries it, which a tag without password mode ignores.
+ *           Every block goes out unlocked first. The blocks to lock are written again after block
+ *           0, in the same order, as the lock pass, so a write the tag took wrong can still be
+ *           fixed by a later one until the lock pass is sent. Block 0 is never locked: a locked
+ *           config can't be changed, and the app has no way to ask for it.
+ * @param      plan  The plan to fill.
+ * @param      tag   What to write.
+*/
+void t5577_plan_build(T5577Plan* plan, const T5577PlanTag* tag) {
+    T5577PlanWrite writes[T5577_PLAN_MAX_WRITES];
+    uint8_t count = t5577_plan_writes(tag, writes);
+    t5577_plan_clear(plan);
+    for(uint8_t i = 0; i < count; i++) {
+        t5577_plan_add_write(plan, tag, &writes[i], false);
+    }
+    uint8_t unlocked_count = plan->command_count;
+    uint32_t unlocked_air_time_us = plan->air_time_us;
+    for(uint8_t i = 0; i < count; i++) {
+        if(tag->lock_mask & writes[i].lock) {
+            t5577_plan_add_write(plan, tag, &writes[i], true);
+        }
+    }
+    plan->lock_count = plan->command_count - unlocked_count;
+    plan->lock_air_time_us = plan->air_time_us - unlocked_air_time_us;
+}
+
+bool t5577_plan_update(
+    T5577Plan* plan,
+    bool* dirty,
+    T5577PlanBuildCallback build,
+    void* context) {
+    if(!*dirty) return false;
+    build(plan, context);
+    *dirty = false;
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef T5577_PLAN_H
+#define T5577_PLAN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <lib/lfrfid/tools/t5577.h>
+
+// Downlink timings in RF cycles, the same as the firmware's lib/lfrfid/tools/t5577.c
+#define T5577_TIMING_WAIT_TIME 400
+#define T5577_TIMING_START_GAP 30
+#define T5577_TIMING_WRITE_GAP 18
+#define T5577_TIMING_DATA_0    24
+#define T5577_TIMING_DATA_1    56
+#define T5577_TIMING_PROGRAM   700
+
+#define T5577_PLAN_RF_CYCLE_US 8 // 125 kHz carrier
+
+#define T5577_PLAN_PAGE_1_BLOCK_COUNT 4 // Page 1 block 0 is the same as page 0 block 0
+#define T5577_PLAN_PASSWORD_BLOCK     7
+
+#define T5577_PLAN_MAX_WRITES   (LFRFID_T5577_BLOCK_COUNT + 3) // Page 0 and page 1 blocks 1-3
+#define T5577_PLAN_MAX_COMMANDS (2 * T5577_PLAN_MAX_WRITES - 1) // Every block but 0 to lock it
+#define T5577_PLAN_MAX_BITS     70 // opcode 2 + password 32 + lock 1 + data 32 + address 3
+
+// One block write, already encoded as the bits sent over the air, MSB first
+typedef struct {
+    uint8_t bit_count;
+    uint8_t bits[(T5577_PLAN_MAX_BITS + 7) / 8];
+} T5577PlanCommand;
+
+// Everything sent to the tag in one field session, in order
+typedef struct {
+    T5577PlanCommand commands[T5577_PLAN_MAX_COMMANDS];
+    uint8_t command_count;
+    uint8_t lock_count; // The last commands set lock bits and are only sent when asked for
+    uint32_t air_time_us; // Time the whole plan takes to replay, the lock pass included
+    uint32_t lock_air_time_us; // Time the lock pass takes
+} T5577Plan;
+
+// What a plan writes to the tag
+typedef struct {
+    uint32_t block_zero; // The config block, already derived from the settings
+    uint32_t content[LFRFID_T5577_BLOCK_COUNT]; // Page 0, block 0 is not used
+    uint8_t user_block_num; // Page 0 blocks 1 to this one are written
+    uint32_t page_1[T5577_PLAN_PAGE_1_BLOCK_COUNT]; // Block 0 is not used
+    bool write_page_1; // Also write page 1 blocks 1-3
+    bool use_password; // Write the password to block 7 and send it with every write
+    uint32_t password;
+    uint16_t lock_mask; // Bits 1-7 lock page 0 blocks 1-7, bits 8-10 page 1 blocks 1-3
+} T5577PlanTag;
+
+// Fills the plan from whatever the context holds
+typedef void (*T5577PlanBuildCallback)(T5577Plan* plan, void* context);
+
+static inline bool t5577_plan_bit(const T5577PlanCommand* command, uint8_t index) {
+    return command->bits[index / 8] & (0x80 >> (index % 8));
+}
+
+void t5577_plan_clear(T5577Plan* plan);
+
+// Encode one block write and append it to the plan. Returns false if the plan is full.
+bool t5577_plan_add_block(
+    T5577Plan* plan,
+    uint8_t page,
+    uint8_t block,
+    uint32_t data,
+    bool lock,
+    bool with_pass,
+    uint32_t password);
+
+// Time one block write takes to replay, its reset included
+uint32_t t5577_plan_command_air_time_us(const T5577PlanCommand* command);
+
+// Encode every write the tag needs, in the order they have to reach it.
+void t5577_plan_build(T5577Plan* plan, const T5577PlanTag* tag);
+
+// Rebuild the plan only if *dirty is set, then clear it. Returns true if the plan was rebuilt.
+bool t5577_plan_update(
+    T5577Plan* plan,
+    bool* dirty,
+    T5577PlanBuildCallback build,
+    void* context);
+
+// Send the plan to the tag, with the lock pass if lock is set. Lives in t5577_plan_write.c, the
+// only part that needs the RF hardware.
+void t5577_plan_write(const T5577Plan* plan, bool lock);
+
+#endif // T5577_PLAN_H
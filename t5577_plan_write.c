@@ -0,0 +1,44 @@
+#include "t5577_plan.h"
+
+#include <furi.h>
+#include <furi_hal.h>
+
+static void t5577_plan_gap(uint32_t cycles) {
+    furi_hal_rfid_tim_read_pause();
+    furi_delay_us(cycles * T5577_PLAN_RF_CYCLE_US);
+    furi_hal_rfid_tim_read_continue();
+}
+
+static void t5577_plan_send_bit(bool value) {
+    furi_delay_us((value ? T5577_TIMING_DATA_1 : T5577_TIMING_DATA_0) * T5577_PLAN_RF_CYCLE_US);
+    t5577_plan_gap(T5577_TIMING_WRITE_GAP);
+}
+
+// Same as the firmware's t5577_write_reset
+static void t5577_plan_send_reset(void) {
+    t5577_plan_gap(T5577_TIMING_START_GAP);
+    t5577_plan_send_bit(true);
+    t5577_plan_send_bit(false);
+}
+
+void t5577_plan_write(const T5577Plan* plan, bool lock) {
+    uint8_t command_count = plan->command_count - (lock ? 0 : plan->lock_count);
+    furi_hal_rfid_tim_read_start(125000, 0.5);
+    furi_hal_rfid_pin_pull_release(); // do not ground the antenna
+    FURI_CRITICAL_ENTER();
+    for(uint8_t c = 0; c < command_count; c++) {
+        const T5577PlanCommand* command = &plan->commands[c];
+        furi_delay_us(T5577_TIMING_WAIT_TIME * T5577_PLAN_RF_CYCLE_US);
+        t5577_plan_gap(T5577_TIMING_START_GAP);
+        for(uint8_t i = 0; i < command->bit_count; i++) {
+            t5577_plan_send_bit(t5577_plan_bit(command, i));
+        }
+        furi_delay_us(T5577_TIMING_PROGRAM * T5577_PLAN_RF_CYCLE_US);
+        furi_delay_us(T5577_TIMING_WAIT_TIME * T5577_PLAN_RF_CYCLE_US);
+        t5577_plan_send_reset();
+    }
+    t5577_plan_send_reset();
+    FURI_CRITICAL_EXIT();
+    furi_hal_rfid_tim_read_stop();
+    furi_hal_rfid_pins_reset();
+}
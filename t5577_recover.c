@@ -0,0 +1,54 @@
+#include "t5577_recover.h"
+
+#include <string.h>
+
+void t5577_recover_reset(T5577Recover* recover) {
+    memset(recover, 0, sizeof(T5577Recover));
+    recover->step = T5577RecoverStepSearch;
+}
+
+void t5577_recover_batch(T5577Recover* recover, uint8_t count) {
+    if(count > T5577_RECOVER_BATCH_SIZE) count = T5577_RECOVER_BATCH_SIZE;
+    recover->candidate_count = count;
+    recover->first = 0;
+    recover->count = count;
+    recover->probe = 0;
+}
+
+// The password is in candidates[first, first + count): send the first half of it next
+static void t5577_recover_narrow(T5577Recover* recover, uint8_t first, uint8_t count) {
+    recover->range_first = first;
+    recover->range_count = count;
+    recover->first = first;
+    if(count <= 1) {
+        recover->count = count;
+        recover->step = T5577RecoverStepFound;
+        return;
+    }
+    recover->count = count / 2;
+    recover->step = T5577RecoverStepBisect;
+}
+
+void t5577_recover_result(T5577Recover* recover, bool took) {
+    switch(recover->step) {
+    case T5577RecoverStepSearch:
+        if(!took) return;
+        // The tag is on probe 0 now, so the halves are sent with probe 1 to see a change
+        recover->probe = 1;
+        t5577_recover_narrow(recover, 0, recover->candidate_count);
+        break;
+    case T5577RecoverStepBisect:
+        if(took) {
+            recover->probe ^= 1;
+            t5577_recover_narrow(recover, recover->first, recover->count);
+        } else {
+            // Nothing in the half that was sent took, so it is in the other one, which the tag
+            // hasn't seen with this probe yet
+            t5577_recover_narrow(
+                recover, recover->first + recover->count, recover->range_count - recover->count);
+        }
+        break;
+    case T5577RecoverStepFound:
+        break;
+    }
+}
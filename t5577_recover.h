@@ -0,0 +1,38 @@
+#ifndef T5577_RECOVER_H
+#define T5577_RECOVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Most candidates sent between two reads of the tag's reply
+#define T5577_RECOVER_BATCH_SIZE 32
+
+// Every candidate is sent as a password write of block 0 with one of two probe configs. Both keep
+// the password bit and differ in how the tag replies, so a read tells which one the tag took last.
+// Probe 0 is what a batch is sent with, and the two are swapped while a hit is narrowed down.
+typedef enum {
+    T5577RecoverStepSearch, // Fill the next batch from the dictionary and send it with probe 0
+    T5577RecoverStepBisect, // A batch had a hit, send the part of it that is asked for
+    T5577RecoverStepFound, // candidates[first] is the password
+} T5577RecoverStep;
+
+typedef struct {
+    uint32_t candidates[T5577_RECOVER_BATCH_SIZE]; // The last batch taken from the dictionary
+    uint8_t candidate_count;
+    T5577RecoverStep step;
+    uint8_t first; // What the next send goes through: candidates[first] on
+    uint8_t count;
+    uint8_t probe; // The probe config the next send writes, 0 or 1
+    uint8_t range_first; // The candidates the password is known to be in
+    uint8_t range_count;
+} T5577Recover;
+
+void t5577_recover_reset(T5577Recover* recover);
+
+// Take candidates[0, count) as the next batch. Only in T5577RecoverStepSearch.
+void t5577_recover_batch(T5577Recover* recover, uint8_t count);
+
+// The reply after the last send: took is set if it shows the probe that send wrote.
+void t5577_recover_result(T5577Recover* recover, bool took);
+
+#endif // T5577_RECOVER_H
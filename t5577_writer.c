@@ -13,12 +13,21 @@
 
 #include <applications/services/storage/storage.h>
 #include <applications/services/dialogs/dialogs.h>
+#include <cli/cli.h>
 #include <dolphin/dolphin.h>
 #include <flipper_format.h>
+#include <toolbox/stream/file_stream.h>
+#include <toolbox/args.h>
+#include <lib/lfrfid/lfrfid_worker.h>
+#include <lib/lfrfid/protocols/lfrfid_protocols.h>
+#include <lib/lfrfid/lfrfid_raw_file.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <t5577_config.h>
+#include <t5577_detect.h>
+#include <t5577_plan.h>
+#include <t5577_recover.h>
 #include <t5577_writer.h>
 
 #include "t5577_writer_icons.h"
@@ -26,11 +35,41 @@
 #define MAX_REPEAT_WRITING_FRAMES  10
 #define ENDING_WRITING_ICON_FRAMES 5
 
+#define T5577_WRITER_SESSION_PATH    STORAGE_APP_DATA_PATH_PREFIX "/.session"
+#define T5577_WRITER_SESSION_MAGIC   0x37373554 // "T577" little endian
+#define T5577_WRITER_SESSION_VERSION 3
+#define T5577_WRITER_TAG_NAME_SIZE   32
+#define T5577_WRITER_PATH_SIZE       128
+
+#define T5577_WRITER_FILE_VERSION 3
+// Editable slots: page 0 blocks 1-7, then page 1 blocks 1-3. Slot 0 (block 0) is derived.
+#define T5577_WRITER_EDIT_SLOT_COUNT \
+    (LFRFID_T5577_BLOCK_COUNT + T5577_PLAN_PAGE_1_BLOCK_COUNT - 1)
+
+#define T5577_WRITER_RECOVER_DICT_PATH       STORAGE_APP_DATA_PATH_PREFIX "/passwords.txt"
+#define T5577_WRITER_RECOVER_CHECKPOINT_PATH STORAGE_APP_DATA_PATH_PREFIX "/.recovery"
+#define T5577_WRITER_REPLY_PATH              STORAGE_APP_DATA_PATH_PREFIX "/.reply.raw"
+#define T5577_WRITER_RECOVER_MAGIC           0x57503554 // "T5PW" little endian
+#define T5577_WRITER_RECOVER_VERSION         2
+#define RECOVER_BATCH_ATTEMPTS               8 // password writes per custom event
+#define RECOVER_CHECKPOINT_BATCHES           2 // batches between checkpoints on the SD card
+#define REPLY_READ_MS                        250 // how long a reply is recorded after writing
+#define REPLY_MIN_CONFIDENCE                 50 // a weaker match counts as no reply
+#define RECOVER_PROBE_CLOCK                  5 // all_rf_clocks index of RF/64
+#define RECOVER_PROBE_CLOCK_ALT              2 // RF/32, when RF/64 is the clock to get away from
+#define T5577_WRITER_BITRATE_MASK            LFRFID_T5577_BITRATE_RF_128 // sets every bitrate bit
+
+#define CAPTURE_DURATION_MS 2000 // how long the raw envelope is recorded for
+
+#define T5577_WRITER_CLI_COMMAND "t5577" // what a host sends over USB serial, see t5577_writer_cli
+
 typedef enum {
     T5577WriterSubmenuIndexLoad,
     T5577WriterSubmenuIndexSave,
     T5577WriterSubmenuIndexConfigure,
     T5577WriterSubmenuIndexWrite,
+    T5577WriterSubmenuIndexRecover,
+    T5577WriterSubmenuIndexCapture,
     T5577WriterSubmenuIndexAbout,
 } T5577WriterSubmenuIndex;
 
@@ -44,16 +83,63 @@ typedef enum {
     T5577WriterViewConfigure_i, // The configuration screen
     T5577WriterViewConfigure_e, // The configuration screen
     T5577WriterViewWrite, // The main screen
+    T5577WriterViewRecover, // The password clearing screen
+    T5577WriterViewCapture, // The raw capture screen
     T5577WriterViewAbout, // The about screen with directions, link to social channel, etc.
 } T5577WriterView;
 
+// Items in the configuration screen, in order
+typedef enum {
+    T5577WriterConfigIndexModulation,
+    T5577WriterConfigIndexRfClock,
+    T5577WriterConfigIndexMaxBlock,
+    T5577WriterConfigIndexEditBlock,
+    T5577WriterConfigIndexBlockData,
+    T5577WriterConfigIndexLock,
+    T5577WriterConfigIndexPassword,
+    T5577WriterConfigIndexPasswordData,
+    T5577WriterConfigIndexPage1,
+    T5577WriterConfigIndexDetect,
+} T5577WriterConfigIndex;
+
 typedef enum {
     T5577WriterEventIdRepeatWriting = 0, // Custom event to redraw the screen
     T5577WriterEventIdMaxWriteRep = 42, // Custom event to process OK button getting pressed down
+    T5577WriterEventIdRecoverBatch = 43, // Custom event to try the next batch of passwords
+    T5577WriterEventIdCaptureDone = 44, // Custom event when the capture time is up
+    T5577WriterEventIdCaptureError = 45, // Custom event when the capture file can't be written
+    T5577WriterEventIdCaptureOverrun = 46, // Custom event when the SD card couldn't keep up
+    T5577WriterEventIdFirstFrame = 47, // Custom event once the first frame was sampled
+    T5577WriterEventIdRecoverRead = 48, // Custom event when the reply after a batch is recorded
 } T5577WriterEventId;
 
+// Startup cost, sampled once from the GUI's framebuffer callback
+typedef struct {
+    uint32_t start_tick; // When the app was started
+    size_t start_free_heap; // Free heap before anything was allocated
+    bool hooked; // The framebuffer callback is still registered
+    volatile bool armed; // Set once the submenu is current, earlier frames aren't ours
+    volatile uint32_t first_frame_tick; // When the first frame was drawn, 0 until then
+    volatile size_t first_frame_free_heap;
+} T5577WriterStartup;
+
+// Where the password recovery stopped, so it can pick up from there next time.
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    bool in_range;
+    uint32_t stream_offset;
+    uint32_t range_next;
+    uint32_t range_end;
+    uint32_t attempts;
+    uint32_t dict_size; // The dictionary the offset points into
+    uint32_t dict_hash;
+} T5577WriterRecoverCheckpoint;
+
 typedef struct {
     ViewDispatcher* view_dispatcher; // Switches between our views
+    Gui* gui;
+    T5577WriterStartup startup;
     NotificationApp* notifications; // Used for controlling the backlight
     Submenu* submenu; // The application menu
 
@@ -70,7 +156,13 @@ typedef struct {
     VariableItem* block_num_item; //
     VariableItem* block_slc_item; //
     VariableItem* byte_buffer_item; //
+    VariableItem* detect_item; //
+    VariableItem* lock_item; //
+    VariableItem* password_item; //
+    VariableItem* password_data_item; //
+    VariableItem* page_1_item; //
     ByteInput* byte_input; // The byte input view
+    uint32_t* byte_input_target; // The block the byte input edits
     uint8_t bytes_buffer[4];
     uint8_t bytes_count;
 
@@ -80,6 +172,28 @@ typedef struct {
     DialogsApp* dialogs;
     FuriString* file_path;
     FuriTimer* timer; // Timer for redrawing the screen
+
+    View* view_recover; // The password clearing screen
+    Stream* recover_stream; // The password dictionary being walked
+    bool recover_running;
+    bool recover_in_range; // Candidates currently come from a range line
+    uint32_t recover_range_next;
+    uint32_t recover_range_end;
+    uint32_t recover_dict_size;
+    uint32_t recover_dict_hash; // FNV-1a, so a checkpoint never resumes an edited dictionary
+    uint8_t recover_batches; // Batches since the last checkpoint
+    T5577WriterRecoverCheckpoint recover_checkpoint; // Where the current batch started
+    T5577Recover recover; // Which candidates go out next, and with which probe
+    uint8_t recover_sent; // Candidates of the current send already written
+    uint32_t recover_probes[2]; // Block 0 of both probe configs
+    uint8_t recover_probe_clocks[2]; // Their RF clock, what a read is matched against
+
+    View* view_capture; // The raw capture screen
+    ProtocolDict* capture_dict;
+    LFRFIDWorker* capture_worker; // Streams the raw envelope to the SD card, also for recovery
+
+    Cli* cli;
+    FuriMutex* rf_mutex; // Held by whoever uses the RF hardware: a screen, or a CLI command
 } T5577WriterApp;
 
 typedef struct {
@@ -88,18 +202,73 @@ typedef struct {
     FuriString* tag_name_str; // The name setting
     uint8_t user_block_num; // The total number of pins we are adjusting
     uint32_t content[LFRFID_T5577_BLOCK_COUNT]; // The cutting content
+    uint32_t page_1[T5577_PLAN_PAGE_1_BLOCK_COUNT]; // Page 1 blocks 1-3, block 0 unused
+    bool write_page_1; // Also write page 1 blocks 1-3
+    bool use_password; // Write block 7 as the password and turn on password mode
+    uint32_t password;
+    uint16_t lock_mask; // One bit per edit slot: page 0 blocks 1-7, page 1 blocks 1-3
     t5577_modulation modulation;
     t5577_rf_clock rf_clock;
     bool data_loaded[3];
     uint8_t edit_block_slc;
     uint8_t writing_repeat_times;
+    T5577Plan plan; // What the write screen sends, built from the config and content
+    bool plan_dirty; // The plan has to be rebuilt before the next write
 } T5577WriterModel;
 
+// Snapshot of the last session, written raw to the SD card on exit and read back on launch.
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t modulation_index;
+    uint8_t rf_clock_index;
+    uint8_t user_block_num;
+    uint8_t edit_block_slc;
+    uint32_t content[LFRFID_T5577_BLOCK_COUNT];
+    uint32_t page_1[T5577_PLAN_PAGE_1_BLOCK_COUNT];
+    bool write_page_1;
+    bool use_password;
+    uint32_t password;
+    // No lock mask: locks are permanent, so they are never carried over to the next launch
+    char tag_name[T5577_WRITER_TAG_NAME_SIZE];
+    char file_path[T5577_WRITER_PATH_SIZE];
+} T5577WriterSession;
+
+typedef enum {
+    T5577WriterRecoverStateReading, // Recording how the tag replies before anything is sent
+    T5577WriterRecoverStateRunning,
+    T5577WriterRecoverStateNarrowing, // A batch had a hit, finding out which password it was
+    T5577WriterRecoverStateVerifying, // Sending the password that was found once more
+    T5577WriterRecoverStateFound,
+    T5577WriterRecoverStateLost, // The password that was found didn't take the second time
+    T5577WriterRecoverStateFinished,
+    T5577WriterRecoverStateNoDictionary,
+} T5577WriterRecoverState;
+
+typedef struct {
+    uint32_t attempts; // Passwords tried so far, including earlier runs
+    uint32_t candidate; // The last password tried, or the one that was found
+    T5577WriterRecoverState state;
+} T5577WriterRecoverModel;
+
+typedef enum {
+    T5577WriterCaptureStateCapturing,
+    T5577WriterCaptureStateDone,
+    T5577WriterCaptureStateError,
+    T5577WriterCaptureStateOverrun,
+} T5577WriterCaptureState;
+
+typedef struct {
+    T5577WriterCaptureState state;
+    bool psk; // The PSK half of the capture is running
+    char file_name[T5577_WRITER_TAG_NAME_SIZE + 16]; // The capture name shown on screen
+} T5577WriterCaptureModel;
+
 void initialize_config(T5577WriterModel* model) {
     model->modulation_index = 0;
     memcpy(&model->modulation, &all_mods[model->modulation_index], sizeof(t5577_modulation));
     model->rf_clock_index = 0;
-    memcpy(&model->rf_clock, &all_mods[model->rf_clock_index], sizeof(t5577_rf_clock));
+    memcpy(&model->rf_clock, &all_rf_clocks[model->rf_clock_index], sizeof(t5577_rf_clock));
 }
 
 void initialize_model(T5577WriterModel* model) {
@@ -107,9 +276,15 @@ void initialize_model(T5577WriterModel* model) {
     model->user_block_num = 0;
     model->edit_block_slc = 1;
     model->writing_repeat_times = 0;
+    model->plan_dirty = true;
     for(uint32_t i = 0; i < LFRFID_T5577_BLOCK_COUNT; i++) {
         model->content[i] = 0;
     }
+    memset(model->page_1, 0, sizeof(model->page_1));
+    model->write_page_1 = false;
+    model->use_password = false;
+    model->password = 0;
+    model->lock_mask = 0;
     memset(model->data_loaded, false, sizeof(model->data_loaded));
 }
 
@@ -129,6 +304,36 @@ void initialize_mod_names(char** modulation_names) {
     }
 }
 
+uint8_t t5577_writer_max_user_block(T5577WriterModel* model) {
+    // With a password, block 7 holds it and the tag must never send it in its reply
+    if(model->use_password) return T5577_PLAN_PASSWORD_BLOCK - 1;
+    return LFRFID_T5577_BLOCK_COUNT - 1;
+}
+
+uint32_t t5577_writer_block_zero(T5577WriterModel* model) {
+    // Block 0 is always derived from the configuration, never edited directly
+    uint32_t block_zero = 0;
+    uint32_t max_block = MIN(model->user_block_num, t5577_writer_max_user_block(model));
+    block_zero |= model->modulation.mod_page_zero;
+    block_zero |= model->rf_clock.clock_page_zero;
+    if(model->use_password) block_zero |= LFRFID_T5577_PWD;
+    block_zero |= (max_block << LFRFID_T5577_MAXBLOCK_SHIFT);
+    return block_zero;
+}
+
+uint32_t* t5577_writer_edit_slot_data(T5577WriterModel* model, uint8_t slot) {
+    if(slot < LFRFID_T5577_BLOCK_COUNT) return &model->content[slot];
+    return &model->page_1[slot - LFRFID_T5577_BLOCK_COUNT + 1];
+}
+
+void t5577_writer_edit_slot_name(uint8_t slot, FuriString* buffer) {
+    if(slot < LFRFID_T5577_BLOCK_COUNT) {
+        furi_string_printf(buffer, "%u", slot);
+    } else {
+        furi_string_printf(buffer, "P1:%u", slot - LFRFID_T5577_BLOCK_COUNT + 1);
+    }
+}
+
 /**
  * @brief      Callback for exiting the application.
  * @details    This function is called when user press back button.  We return VIEW_NONE to
@@ -158,6 +363,139 @@ static uint32_t t5577_writer_navigation_config_e_callback(void* _context) {
     return T5577WriterViewConfigure_e;
 }
 
+static void t5577_writer_view_load_callback(void* context);
+static void t5577_writer_view_save_callback(void* context);
+static void t5577_writer_config_enter_callback(void* context);
+static void t5577_writer_view_recover_draw_callback(Canvas* canvas, void* model);
+static void t5577_writer_view_recover_enter_callback(void* context);
+static void t5577_writer_view_recover_exit_callback(void* context);
+static bool t5577_writer_view_recover_custom_event_callback(uint32_t event, void* context);
+static bool t5577_writer_recover_confirm(T5577WriterApp* app);
+static void t5577_writer_view_capture_draw_callback(Canvas* canvas, void* model);
+static void t5577_writer_view_capture_enter_callback(void* context);
+static void t5577_writer_view_capture_exit_callback(void* context);
+static bool t5577_writer_view_capture_custom_event_callback(uint32_t event, void* context);
+
+/**
+ * @brief      Make sure a view exists before switching to it.
+ * @details    Views are only allocated and added to the dispatcher the first time they are needed,
+ *           so the app can draw its first frame with nothing but the submenu and the write view.
+ * @param      app   The T5577WriterApp object.
+ * @param      view  The T5577WriterView to prepare.
+*/
+static void t5577_writer_view_prepare(T5577WriterApp* app, T5577WriterView view) {
+    switch(view) {
+    case T5577WriterViewTextInput:
+        if(app->text_input == NULL) {
+            app->text_input = text_input_alloc();
+            view_dispatcher_add_view(
+                app->view_dispatcher,
+                T5577WriterViewTextInput,
+                text_input_get_view(app->text_input));
+        }
+        break;
+    case T5577WriterViewByteInput:
+        if(app->byte_input == NULL) {
+            app->byte_input = byte_input_alloc();
+            view_dispatcher_add_view(
+                app->view_dispatcher,
+                T5577WriterViewByteInput,
+                byte_input_get_view(app->byte_input));
+        }
+        break;
+    case T5577WriterViewLoad:
+        if(app->view_load == NULL) {
+            app->view_load = view_alloc();
+            view_set_previous_callback(app->view_load, t5577_writer_navigation_submenu_callback);
+            view_set_enter_callback(app->view_load, t5577_writer_view_load_callback);
+            view_set_context(app->view_load, app);
+            view_dispatcher_add_view(app->view_dispatcher, T5577WriterViewLoad, app->view_load);
+        }
+        break;
+    case T5577WriterViewSave:
+        if(app->view_save == NULL) {
+            app->view_save = view_alloc();
+            view_set_previous_callback(app->view_save, t5577_writer_navigation_submenu_callback);
+            view_set_enter_callback(app->view_save, t5577_writer_view_save_callback);
+            view_set_context(app->view_save, app);
+            view_dispatcher_add_view(app->view_dispatcher, T5577WriterViewSave, app->view_save);
+        }
+        break;
+    case T5577WriterViewConfigure_i:
+        if(app->variable_item_list_config == NULL) {
+            app->variable_item_list_config = variable_item_list_alloc();
+            view_dispatcher_add_view(
+                app->view_dispatcher,
+                T5577WriterViewConfigure_i,
+                variable_item_list_get_view(app->variable_item_list_config));
+        }
+        break;
+    case T5577WriterViewConfigure_e:
+        if(app->view_config_e == NULL) {
+            app->view_config_e = view_alloc();
+            view_set_previous_callback(
+                app->view_config_e, t5577_writer_navigation_submenu_callback);
+            view_set_enter_callback(app->view_config_e, t5577_writer_config_enter_callback);
+            view_set_context(app->view_config_e, app);
+            view_dispatcher_add_view(
+                app->view_dispatcher, T5577WriterViewConfigure_e, app->view_config_e);
+        }
+        break;
+    case T5577WriterViewRecover:
+        if(app->view_recover == NULL) {
+            app->view_recover = view_alloc();
+            view_set_draw_callback(app->view_recover, t5577_writer_view_recover_draw_callback);
+            view_set_previous_callback(
+                app->view_recover, t5577_writer_navigation_submenu_callback);
+            view_set_enter_callback(app->view_recover, t5577_writer_view_recover_enter_callback);
+            view_set_exit_callback(app->view_recover, t5577_writer_view_recover_exit_callback);
+            view_set_context(app->view_recover, app);
+            view_set_custom_callback(
+                app->view_recover, t5577_writer_view_recover_custom_event_callback);
+            view_allocate_model(
+                app->view_recover, ViewModelTypeLockFree, sizeof(T5577WriterRecoverModel));
+            view_dispatcher_add_view(
+                app->view_dispatcher, T5577WriterViewRecover, app->view_recover);
+        }
+        break;
+    case T5577WriterViewCapture:
+        if(app->view_capture == NULL) {
+            app->view_capture = view_alloc();
+            view_set_draw_callback(app->view_capture, t5577_writer_view_capture_draw_callback);
+            view_set_previous_callback(
+                app->view_capture, t5577_writer_navigation_submenu_callback);
+            view_set_enter_callback(app->view_capture, t5577_writer_view_capture_enter_callback);
+            view_set_exit_callback(app->view_capture, t5577_writer_view_capture_exit_callback);
+            view_set_context(app->view_capture, app);
+            view_set_custom_callback(
+                app->view_capture, t5577_writer_view_capture_custom_event_callback);
+            view_allocate_model(
+                app->view_capture, ViewModelTypeLockFree, sizeof(T5577WriterCaptureModel));
+            view_dispatcher_add_view(
+                app->view_dispatcher, T5577WriterViewCapture, app->view_capture);
+        }
+        break;
+    case T5577WriterViewAbout:
+        if(app->widget_about == NULL) {
+            app->widget_about = widget_alloc();
+            widget_add_text_scroll_element(
+                app->widget_about,
+                0,
+                0,
+                128,
+                64,
+                "T5577 Raw Writer v1.2\n\nAuthor: @Torron\n\nGithub: https://github.com/zinongli/T5577_Raw_Writer");
+            view_set_previous_callback(
+                widget_get_view(app->widget_about), t5577_writer_navigation_submenu_callback);
+            view_dispatcher_add_view(
+                app->view_dispatcher, T5577WriterViewAbout, widget_get_view(app->widget_about));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
 /**
  * @brief      Handle submenu item selection.
  * @details    This function is called when user selects an item from the submenu.
@@ -168,18 +506,31 @@ static void t5577_writer_submenu_callback(void* context, uint32_t index) {
     T5577WriterApp* app = (T5577WriterApp*)context;
     switch(index) {
     case T5577WriterSubmenuIndexLoad:
+        t5577_writer_view_prepare(app, T5577WriterViewLoad);
         view_dispatcher_switch_to_view(app->view_dispatcher, T5577WriterViewLoad);
         break;
     case T5577WriterSubmenuIndexSave:
+        t5577_writer_view_prepare(app, T5577WriterViewSave);
         view_dispatcher_switch_to_view(app->view_dispatcher, T5577WriterViewSave);
         break;
     case T5577WriterSubmenuIndexConfigure:
+        t5577_writer_view_prepare(app, T5577WriterViewConfigure_e);
         view_dispatcher_switch_to_view(app->view_dispatcher, T5577WriterViewConfigure_e);
         break;
     case T5577WriterSubmenuIndexWrite:
         view_dispatcher_switch_to_view(app->view_dispatcher, T5577WriterViewWrite);
         break;
+    case T5577WriterSubmenuIndexRecover:
+        if(!t5577_writer_recover_confirm(app)) break;
+        t5577_writer_view_prepare(app, T5577WriterViewRecover);
+        view_dispatcher_switch_to_view(app->view_dispatcher, T5577WriterViewRecover);
+        break;
+    case T5577WriterSubmenuIndexCapture:
+        t5577_writer_view_prepare(app, T5577WriterViewCapture);
+        view_dispatcher_switch_to_view(app->view_dispatcher, T5577WriterViewCapture);
+        break;
     case T5577WriterSubmenuIndexAbout:
+        t5577_writer_view_prepare(app, T5577WriterViewAbout);
         view_dispatcher_switch_to_view(app->view_dispatcher, T5577WriterViewAbout);
         break;
     default:
@@ -195,6 +546,7 @@ static void t5577_writer_modulation_change(VariableItem* item) {
         variable_item_set_current_value_index(item, model->modulation_index);
     } else {
         uint8_t modulation_index = variable_item_get_current_value_index(item);
+        if(modulation_index != model->modulation_index) model->plan_dirty = true;
         model->modulation_index = modulation_index;
         model->modulation = all_mods[modulation_index];
     }
@@ -210,6 +562,7 @@ static void t5577_writer_rf_clock_change(VariableItem* item) {
         variable_item_set_current_value_index(item, model->rf_clock_index);
     } else {
         uint8_t rf_clock_index = variable_item_get_current_value_index(item);
+        if(rf_clock_index != model->rf_clock_index) model->plan_dirty = true;
         model->rf_clock_index = rf_clock_index;
         model->rf_clock = all_rf_clocks[rf_clock_index];
     }
@@ -228,11 +581,15 @@ static void t5577_writer_user_block_num_change(VariableItem* item) {
         variable_item_set_current_value_index(item, model->user_block_num);
     } else {
         uint8_t user_block_num_index = variable_item_get_current_value_index(item);
+        if(user_block_num_index != model->user_block_num) model->plan_dirty = true;
         model->user_block_num = user_block_num_index;
     }
     model->data_loaded[2] = false;
     FuriString* buffer = furi_string_alloc();
-    furi_string_printf(buffer, "%u", model->user_block_num);
+    // Show what block 0 will say. The setting itself is kept, so block 7 comes back with it
+    // once the password is off.
+    furi_string_printf(
+        buffer, "%u", MIN(model->user_block_num, t5577_writer_max_user_block(model)));
     variable_item_set_current_value_text(item, furi_string_get_cstr(buffer));
     for(uint8_t i = model->user_block_num + 1; i < LFRFID_T5577_BLOCK_COUNT; i++) {
         model->content[i] = 0; // pad the unneeded blocks with zeros
@@ -248,65 +605,133 @@ static void t5577_writer_edit_block_slc_change(VariableItem* item) {
     model->edit_block_slc = edit_block_slc_index + 1;
     variable_item_set_current_value_index(item, model->edit_block_slc - 1);
     FuriString* buffer = furi_string_alloc();
-    furi_string_printf(buffer, "%u", model->edit_block_slc);
+    t5577_writer_edit_slot_name(model->edit_block_slc, buffer);
     variable_item_set_current_value_text(item, furi_string_get_cstr(buffer));
 
-    furi_string_printf(buffer, "%08lX", model->content[model->edit_block_slc]);
+    furi_string_printf(buffer, "%08lX", *t5577_writer_edit_slot_data(model, model->edit_block_slc));
     variable_item_set_current_value_text(app->byte_buffer_item, furi_string_get_cstr(buffer));
 
+    bool locked = model->lock_mask & (1 << model->edit_block_slc);
+    variable_item_set_current_value_index(app->lock_item, locked);
+    variable_item_set_current_value_text(app->lock_item, locked ? "On" : "Off");
+
     furi_string_free(buffer);
 }
 
+static const char* lock_config_label = "Lock Block";
+static void t5577_writer_lock_change(VariableItem* item) {
+    T5577WriterApp* app = variable_item_get_context(item);
+    T5577WriterModel* model = view_get_model(app->view_write);
+    bool locked = variable_item_get_current_value_index(item);
+    uint16_t lock_mask = model->lock_mask & ~(1 << model->edit_block_slc);
+    if(locked) lock_mask |= (1 << model->edit_block_slc);
+    if(lock_mask != model->lock_mask) model->plan_dirty = true;
+    model->lock_mask = lock_mask;
+    variable_item_set_current_value_text(item, locked ? "On" : "Off");
+}
+
+static const char* password_config_label = "Password";
+static void t5577_writer_password_change(VariableItem* item) {
+    T5577WriterApp* app = variable_item_get_context(item);
+    T5577WriterModel* model = view_get_model(app->view_write);
+    bool use_password = variable_item_get_current_value_index(item);
+    if(use_password != model->use_password) model->plan_dirty = true;
+    model->use_password = use_password;
+    variable_item_set_current_value_text(item, use_password ? "On" : "Off");
+    t5577_writer_user_block_num_change(app->block_num_item); // show the capped max block
+}
+
+static const char* page_1_config_label = "Write Page 1";
+static void t5577_writer_page_1_change(VariableItem* item) {
+    T5577WriterApp* app = variable_item_get_context(item);
+    T5577WriterModel* model = view_get_model(app->view_write);
+    bool write_page_1 = variable_item_get_current_value_index(item);
+    if(write_page_1 != model->write_page_1) model->plan_dirty = true;
+    model->write_page_1 = write_page_1;
+    variable_item_set_current_value_text(item, write_page_1 ? "On" : "Off");
+}
+
 static const char* tag_name_entry_text = "Enter name";
 static const char* tag_name_default_value = "Tag_1";
-static void t5577_writer_file_saver(void* context) {
-    T5577WriterApp* app = (T5577WriterApp*)context;
+/**
+ * @brief      Write the current tag to a .t5577 file.
+ * @param      app   The T5577WriterApp object.
+ * @param      path  The file to write.
+ * @return     true if the whole file was written.
+*/
+static bool t5577_writer_save_file(T5577WriterApp* app, const char* path) {
     T5577WriterModel* model = view_get_model(app->view_write);
-    model->content[0] = 0; // clean up first block before deciding to write or save
-    model->content[0] |= model->modulation.mod_page_zero;
-    model->content[0] |= model->rf_clock.clock_page_zero;
-    model->content[0] |= (model->user_block_num << LFRFID_T5577_MAXBLOCK_SHIFT);
-    bool redraw = true;
-    with_view_model(
-        app->view_write,
-        T5577WriterModel * model,
-        { furi_string_set(model->tag_name_str, app->temp_buffer); },
-        redraw);
-    FuriString* file_path = furi_string_alloc();
-    furi_string_printf(
-        file_path,
-        "%s/%s%s",
-        STORAGE_APP_DATA_PATH_PREFIX,
-        furi_string_get_cstr(model->tag_name_str),
-        T5577_WRITER_FILE_EXTENSION);
-
+    model->content[0] = t5577_writer_block_zero(model); // clean up first block before saving
     Storage* storage = furi_record_open(RECORD_STORAGE);
     storage_simply_mkdir(storage, STORAGE_APP_DATA_PATH_PREFIX);
     FuriString* buffer = furi_string_alloc();
     FlipperFormat* format = flipper_format_file_alloc(storage);
+    bool saved = false;
     do {
-        const uint32_t version = 2;
+        const uint32_t version = T5577_WRITER_FILE_VERSION;
         const uint32_t clock_buffer = (uint32_t)model->rf_clock.rf_clock_num;
-        const uint32_t block_num_buffer = (uint32_t)model->user_block_num;
-        if(!flipper_format_file_open_always(format, furi_string_get_cstr(file_path))) break;
+        const uint32_t block_num_buffer =
+            (uint32_t)MIN(model->user_block_num, t5577_writer_max_user_block(model));
+        const uint32_t lock_mask_buffer = (uint32_t)model->lock_mask;
+        uint8_t byte_array_buffer[app->bytes_count];
+        if(!flipper_format_file_open_always(format, path)) break;
         if(!flipper_format_write_header_cstr(format, "Flipper T5577 Raw File", version)) break;
         if(!flipper_format_write_string_cstr(
                format, "Modulation", model->modulation.modulation_name))
             break;
         if(!flipper_format_write_uint32(format, "RF Clock", &clock_buffer, 1)) break;
         if(!flipper_format_write_uint32(format, "Max User Block", &block_num_buffer, 1)) break;
+        if(!flipper_format_write_bool(format, "Password Enabled", &model->use_password, 1)) break;
+        uint32_to_byte_buffer(model->password, byte_array_buffer);
+        if(!flipper_format_write_hex(format, "Password", byte_array_buffer, app->bytes_count))
+            break;
+        if(!flipper_format_write_bool(format, "Write Page 1", &model->write_page_1, 1)) break;
+        if(!flipper_format_write_uint32(format, "Lock Mask", &lock_mask_buffer, 1)) break;
         if(!flipper_format_write_string_cstr(format, "Raw Data", "")) break; // raw data begins
-        for(int i = 0; i < LFRFID_T5577_BLOCK_COUNT; i++) {
+        size_t i = 0;
+        for(; i < LFRFID_T5577_BLOCK_COUNT; i++) {
             furi_string_printf(buffer, "Block %u", i);
-            uint8_t byte_array_buffer[app->bytes_count];
             uint32_to_byte_buffer(model->content[i], byte_array_buffer);
             if(!flipper_format_write_hex(
                    format, furi_string_get_cstr(buffer), byte_array_buffer, app->bytes_count))
                 break;
         }
-        // signal that the file was written successfully
+        if(i != LFRFID_T5577_BLOCK_COUNT) break;
+        for(i = 1; i < T5577_PLAN_PAGE_1_BLOCK_COUNT; i++) {
+            furi_string_printf(buffer, "Page 1 Block %u", i);
+            uint32_to_byte_buffer(model->page_1[i], byte_array_buffer);
+            if(!flipper_format_write_hex(
+                   format, furi_string_get_cstr(buffer), byte_array_buffer, app->bytes_count))
+                break;
+        }
+        saved = i == T5577_PLAN_PAGE_1_BLOCK_COUNT; // signal that the file was written successfully
     } while(0);
     flipper_format_free(format);
+    furi_string_free(buffer);
+    furi_record_close(RECORD_STORAGE);
+    return saved;
+}
+
+static void t5577_writer_file_saver(void* context) {
+    T5577WriterApp* app = (T5577WriterApp*)context;
+    T5577WriterModel* model = view_get_model(app->view_write);
+    bool redraw = true;
+    with_view_model(
+        app->view_write,
+        T5577WriterModel * model,
+        { furi_string_set(model->tag_name_str, app->temp_buffer); },
+        redraw);
+    FuriString* file_path = furi_string_alloc();
+    furi_string_printf(
+        file_path,
+        "%s/%s%s",
+        STORAGE_APP_DATA_PATH_PREFIX,
+        furi_string_get_cstr(model->tag_name_str),
+        T5577_WRITER_FILE_EXTENSION);
+    if(!t5577_writer_save_file(app, furi_string_get_cstr(file_path))) {
+        FURI_LOG_E(TAG, "Failed to save %s", furi_string_get_cstr(file_path));
+    }
+    furi_string_free(file_path);
 
     view_dispatcher_switch_to_view(
         app->view_dispatcher, T5577WriterViewSubmenu); // maybe add a pop up later
@@ -330,17 +755,22 @@ void t5577_writer_update_config_from_load(void* context) {
         }
     }
     my_model->user_block_num = ((my_model->content[0] >> LFRFID_T5577_MAXBLOCK_SHIFT) & 0x7);
+    my_model->use_password = my_model->content[0] & LFRFID_T5577_PWD;
     FURI_LOG_D(TAG, "BLOCK 0 %08lX", my_model->content[0]);
     FURI_LOG_D(TAG, "bit 25-27 %ld", (my_model->content[0] >> LFRFID_T5577_MAXBLOCK_SHIFT) & 0x7);
     memset(my_model->data_loaded, true, sizeof(my_model->data_loaded)); // Everything is loaded
+    my_model->plan_dirty = true;
 }
 
 static const char* edit_block_data_config_label = "Block Data";
+static const char* password_data_config_label = "Password Data";
 
 static void t5577_writer_content_byte_input_confirmed(void* context) {
     T5577WriterApp* app = (T5577WriterApp*)context;
     T5577WriterModel* my_model = view_get_model(app->view_write);
-    my_model->content[my_model->edit_block_slc] = byte_buffer_to_uint32(app->bytes_buffer);
+    uint32_t block_data = byte_buffer_to_uint32(app->bytes_buffer);
+    if(block_data != *app->byte_input_target) my_model->plan_dirty = true;
+    *app->byte_input_target = block_data;
     view_dispatcher_switch_to_view(app->view_dispatcher, T5577WriterViewConfigure_e);
 }
 
@@ -348,23 +778,127 @@ static void t5577_writer_content_byte_changed(void* context) {
     UNUSED(context);
 }
 
+static const char* detect_config_label = "Detect";
+
+/**
+ * @brief      Feed a raw capture to the detector.
+ * @param      detect  The T5577Detect object, reset here to the capture's frequency.
+ * @param      path    The .raw file to read.
+ * @param      pairs   Where to put the number of periods fed.
+ * @return     true if the file was read and captures at its frequency can be scored.
+*/
+static bool
+    t5577_writer_detect_read_file(T5577Detect* detect, const char* path, uint32_t* pairs) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    LFRFIDRawFile* raw_file = lfrfid_raw_file_alloc(storage);
+    bool supported = false;
+    float frequency, duty_cycle;
+    *pairs = 0;
+    if(lfrfid_raw_file_open_read(raw_file, path) &&
+       lfrfid_raw_file_read_header(raw_file, &frequency, &duty_cycle)) {
+        supported = t5577_detect_reset(detect, frequency);
+        if(!supported) {
+            FURI_LOG_W(
+                TAG,
+                "Can't detect from a %.0f Hz, %.2f duty capture",
+                (double)frequency,
+                (double)duty_cycle);
+        }
+        // read_pair starts over at the end of the file and sets pass_end, it doesn't return false
+        uint32_t duration, pulse;
+        bool pass_end = false;
+        while(supported && lfrfid_raw_file_read_pair(raw_file, &duration, &pulse, &pass_end) &&
+              !pass_end) {
+            t5577_detect_feed(detect, duration, pulse);
+            (*pairs)++;
+        }
+    }
+    lfrfid_raw_file_free(raw_file);
+    furi_record_close(RECORD_STORAGE);
+    return supported;
+}
+
+/**
+ * @brief      Detect the modulation and RF clock from the last capture.
+ * @details    Reads "<tag name>_capture.ask.raw" written by the capture screen, scores every
+ *           modulation and RF clock against it and applies the best match.  The confidence is shown
+ *           as the value of the Detect item.  Only the 125 kHz ASK capture is scored, PSK included:
+ *           the PSK capture's 62.5 kHz excitation isn't something the detector can model.
+ * @param      app  The T5577WriterApp object.
+*/
+static void t5577_writer_detect(T5577WriterApp* app) {
+    T5577WriterModel* model = view_get_model(app->view_write);
+    FuriString* file_path = furi_string_alloc();
+    furi_string_printf(
+        file_path,
+        "%s/%s_capture.ask.raw",
+        STORAGE_APP_DATA_PATH_PREFIX,
+        furi_string_get_cstr(model->tag_name_str));
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    bool found = storage_file_exists(storage, furi_string_get_cstr(file_path));
+    furi_record_close(RECORD_STORAGE);
+
+    uint32_t start_tick = furi_get_tick();
+    uint32_t pairs = 0;
+    T5577Detect* detect = t5577_detect_alloc();
+    bool supported =
+        found && t5577_writer_detect_read_file(detect, furi_string_get_cstr(file_path), &pairs);
+    furi_string_free(file_path);
+
+    T5577DetectResult result;
+    if(t5577_detect_result(detect, &result)) {
+        FURI_LOG_I(
+            TAG,
+            "Detected %s RF/%u (%u%%) from %lu periods in %lu ms",
+            all_mods[result.modulation_index].modulation_name,
+            all_rf_clocks[result.rf_clock_index].rf_clock_num,
+            result.confidence,
+            pairs,
+            furi_get_tick() - start_tick);
+        model->modulation_index = result.modulation_index;
+        model->modulation = all_mods[model->modulation_index];
+        model->rf_clock_index = result.rf_clock_index;
+        model->rf_clock = all_rf_clocks[model->rf_clock_index];
+        model->plan_dirty = true;
+        model->data_loaded[0] = true;
+        model->data_loaded[1] = true;
+        t5577_writer_modulation_change(app->mod_item);
+        t5577_writer_rf_clock_change(app->clock_item);
+        FuriString* buffer = furi_string_alloc();
+        furi_string_printf(buffer, "%u%%", result.confidence);
+        variable_item_set_current_value_text(app->detect_item, furi_string_get_cstr(buffer));
+        furi_string_free(buffer);
+    } else {
+        const char* reason = "No capture";
+        if(found) reason = supported ? "No match" : "Bad capture";
+        variable_item_set_current_value_text(app->detect_item, reason);
+    }
+    t5577_detect_free(detect);
+}
+
 static void t5577_writer_config_item_clicked(void* context, uint32_t index) {
     T5577WriterApp* app = (T5577WriterApp*)context;
     T5577WriterModel* my_model = view_get_model(app->view_write);
     FuriString* buffer = furi_string_alloc();
-    furi_string_printf(buffer, "Enter Block %u Data", my_model->edit_block_slc);
-    // Our hex input UI is the 5th in the config menue.
-    if(index == 4) {
+    if(index == T5577WriterConfigIndexBlockData) {
+        app->byte_input_target = t5577_writer_edit_slot_data(my_model, my_model->edit_block_slc);
+        furi_string_set(buffer, "Enter Block ");
+        FuriString* slot_name = furi_string_alloc();
+        t5577_writer_edit_slot_name(my_model->edit_block_slc, slot_name);
+        furi_string_cat(buffer, slot_name);
+        furi_string_cat(buffer, " Data");
+        furi_string_free(slot_name);
+    } else if(index == T5577WriterConfigIndexPasswordData) {
+        app->byte_input_target = &my_model->password;
+        furi_string_set(buffer, "Enter Password");
+    }
+    if(index == T5577WriterConfigIndexBlockData || index == T5577WriterConfigIndexPasswordData) {
+        t5577_writer_view_prepare(app, T5577WriterViewByteInput);
         // Header to display on the text input screen.
         byte_input_set_header_text(app->byte_input, furi_string_get_cstr(buffer));
 
-        // Copy the current name into the temporary buffer.
-        bool redraw = false;
-        with_view_model(
-            app->view_write,
-            T5577WriterModel * model,
-            { uint32_to_byte_buffer(model->content[model->edit_block_slc], app->bytes_buffer); },
-            redraw);
+        // Copy the current value into the temporary buffer.
+        uint32_to_byte_buffer(*app->byte_input_target, app->bytes_buffer);
 
         // Configure the text input.  When user enters text and clicks OK, key_copier_setting_text_updated be called.
         byte_input_set_result_callback(
@@ -381,11 +915,15 @@ static void t5577_writer_config_item_clicked(void* context, uint32_t index) {
 
         // Show text input dialog.
         view_dispatcher_switch_to_view(app->view_dispatcher, T5577WriterViewByteInput);
+    } else if(index == T5577WriterConfigIndexDetect) {
+        t5577_writer_detect(app);
     }
+    furi_string_free(buffer);
 }
 static void t5577_writer_config_enter_callback(void* context) {
     T5577WriterApp* app = (T5577WriterApp*)context;
     T5577WriterModel* my_model = view_get_model(app->view_write);
+    t5577_writer_view_prepare(app, T5577WriterViewConfigure_i);
     variable_item_list_reset(app->variable_item_list_config);
     // Recreate this view every time we enter it so that it's always updated
     app->mod_item = variable_item_list_add(
@@ -409,11 +947,26 @@ static void t5577_writer_config_enter_callback(void* context) {
     app->block_slc_item = variable_item_list_add(
         app->variable_item_list_config,
         edit_block_slc_config_label,
-        LFRFID_T5577_BLOCK_COUNT - 1,
+        T5577_WRITER_EDIT_SLOT_COUNT - 1,
         t5577_writer_edit_block_slc_change,
         app);
     app->byte_buffer_item = variable_item_list_add(
         app->variable_item_list_config, edit_block_data_config_label, 1, NULL, app);
+    app->lock_item = variable_item_list_add(
+        app->variable_item_list_config, lock_config_label, 2, t5577_writer_lock_change, app);
+    app->password_item = variable_item_list_add(
+        app->variable_item_list_config,
+        password_config_label,
+        2,
+        t5577_writer_password_change,
+        app);
+    app->password_data_item = variable_item_list_add(
+        app->variable_item_list_config, password_data_config_label, 1, NULL, app);
+    app->page_1_item = variable_item_list_add(
+        app->variable_item_list_config, page_1_config_label, 2, t5577_writer_page_1_change, app);
+    app->detect_item =
+        variable_item_list_add(app->variable_item_list_config, detect_config_label, 1, NULL, app);
+    variable_item_set_current_value_text(app->detect_item, "OK");
     variable_item_list_set_enter_callback(
         app->variable_item_list_config, t5577_writer_config_item_clicked, app);
 
@@ -423,20 +976,24 @@ static void t5577_writer_config_enter_callback(void* context) {
     variable_item_set_current_value_index(app->clock_item, my_model->rf_clock_index);
     variable_item_set_current_value_index(app->block_num_item, my_model->user_block_num);
     variable_item_set_current_value_index(app->block_slc_item, my_model->edit_block_slc - 1);
+    variable_item_set_current_value_index(app->password_item, my_model->use_password);
+    variable_item_set_current_value_index(app->page_1_item, my_model->write_page_1);
 
     t5577_writer_modulation_change(app->mod_item);
     t5577_writer_rf_clock_change(app->clock_item);
     t5577_writer_user_block_num_change(app->block_num_item);
     t5577_writer_edit_block_slc_change(app->block_slc_item);
+    t5577_writer_password_change(app->password_item);
+    t5577_writer_page_1_change(app->page_1_item);
+    FuriString* buffer = furi_string_alloc();
+    furi_string_printf(buffer, "%08lX", my_model->password);
+    variable_item_set_current_value_text(app->password_data_item, furi_string_get_cstr(buffer));
+    furi_string_free(buffer);
     view_set_previous_callback(view_config_i, t5577_writer_navigation_submenu_callback);
-    view_dispatcher_remove_view(
-        app->view_dispatcher, T5577WriterViewConfigure_i); // delete the last one
-    view_dispatcher_add_view(app->view_dispatcher, T5577WriterViewConfigure_i, view_config_i);
-    view_dispatcher_switch_to_view(
-        app->view_dispatcher, T5577WriterViewConfigure_i); // recreate it
+    view_dispatcher_switch_to_view(app->view_dispatcher, T5577WriterViewConfigure_i);
 }
 
-void t5577_writer_view_load_callback(void* context) {
+static void t5577_writer_view_load_callback(void* context) {
     T5577WriterApp* app = (T5577WriterApp*)context;
     T5577WriterModel* model = view_get_model(app->view_write);
     DialogsFileBrowserOptions browser_options;
@@ -444,28 +1001,65 @@ void t5577_writer_view_load_callback(void* context) {
     storage_simply_mkdir(storage, STORAGE_APP_DATA_PATH_PREFIX);
     dialog_file_browser_set_basic_options(&browser_options, T5577_WRITER_FILE_EXTENSION, &I_icon);
     browser_options.base_path = STORAGE_APP_DATA_PATH_PREFIX;
-    furi_string_set(app->file_path, browser_options.base_path);
+    if(furi_string_empty(app->file_path)) {
+        furi_string_set(app->file_path, browser_options.base_path);
+    }
     FuriString* buffer = furi_string_alloc();
     if(dialog_file_browser_show(app->dialogs, app->file_path, app->file_path, &browser_options)) {
         FlipperFormat* format = flipper_format_file_alloc(storage);
+        bool loaded = false;
         do {
             if(!flipper_format_file_open_existing(format, furi_string_get_cstr(app->file_path)))
                 break;
             uint8_t byte_array_buffer[app->bytes_count];
-            for(int i = 0; i < LFRFID_T5577_BLOCK_COUNT; i++) {
+            uint32_t content[LFRFID_T5577_BLOCK_COUNT];
+            int i = 0;
+            for(; i < LFRFID_T5577_BLOCK_COUNT; i++) {
                 furi_string_printf(buffer, "Block %u", i);
                 if(!flipper_format_read_hex(
                        format, furi_string_get_cstr(buffer), byte_array_buffer, app->bytes_count))
                     break;
-                model->content[i] = byte_buffer_to_uint32(
+                content[i] = byte_buffer_to_uint32(
                     byte_array_buffer); // we only extract the raw data. configs are then updated from block 0
             }
-            // signal that the file was read successfully
+            if(i != LFRFID_T5577_BLOCK_COUNT) break; // keep the current tag rather than half of one
+            memcpy(model->content, content, sizeof(model->content));
+            // The rest is optional. Files without these keys load with the password from block 7,
+            // no page 1 and no locks. Whether the password is used comes from block 0 only.
+            model->password = model->content[T5577_PLAN_PASSWORD_BLOCK];
+            model->write_page_1 = false;
+            model->lock_mask = 0;
+            memset(model->page_1, 0, sizeof(model->page_1));
+            flipper_format_rewind(format);
+            if(flipper_format_read_hex(format, "Password", byte_array_buffer, app->bytes_count)) {
+                model->password = byte_buffer_to_uint32(byte_array_buffer);
+            }
+            flipper_format_rewind(format);
+            flipper_format_read_bool(format, "Write Page 1", &model->write_page_1, 1);
+            uint32_t lock_mask_buffer = 0;
+            flipper_format_rewind(format);
+            if(flipper_format_read_uint32(format, "Lock Mask", &lock_mask_buffer, 1)) {
+                model->lock_mask = (uint16_t)lock_mask_buffer;
+            }
+            for(i = 1; i < T5577_PLAN_PAGE_1_BLOCK_COUNT; i++) {
+                furi_string_printf(buffer, "Page 1 Block %u", i);
+                flipper_format_rewind(format);
+                if(!flipper_format_read_hex(
+                       format, furi_string_get_cstr(buffer), byte_array_buffer, app->bytes_count))
+                    break;
+                model->page_1[i] = byte_buffer_to_uint32(byte_array_buffer);
+            }
+            loaded = true;
         } while(0);
         flipper_format_free(format);
-        t5577_writer_update_config_from_load(app);
-        furi_record_close(RECORD_STORAGE);
+        if(loaded) {
+            t5577_writer_update_config_from_load(app);
+        } else {
+            FURI_LOG_E(TAG, "Failed to load %s", furi_string_get_cstr(app->file_path));
+        }
     }
+    furi_string_free(buffer);
+    furi_record_close(RECORD_STORAGE);
     view_dispatcher_switch_to_view(app->view_dispatcher, T5577WriterViewSubmenu);
 }
 
@@ -477,6 +1071,7 @@ void t5577_writer_view_load_callback(void* context) {
 */
 static void t5577_writer_view_save_callback(void* context) {
     T5577WriterApp* app = (T5577WriterApp*)context;
+    t5577_writer_view_prepare(app, T5577WriterViewTextInput);
     // Header to display on the text input screen.
     text_input_set_header_text(app->text_input, tag_name_entry_text);
     // Copy the current name into the temporary buffer.
@@ -508,19 +1103,41 @@ static void t5577_writer_view_save_callback(void* context) {
     view_dispatcher_switch_to_view(app->view_dispatcher, T5577WriterViewTextInput);
 }
 
+/**
+ * @brief      Build the write plan from the config and content.
+ * @details    Block 0 is derived from the config here, so the content isn't touched.
+ * @param      plan     The plan to fill.
+ * @param      context  The T5577WriterModel object.
+*/
+static void t5577_writer_plan_build(T5577Plan* plan, void* context) {
+    T5577WriterModel* model = context;
+    T5577PlanTag tag = {
+        .block_zero = t5577_writer_block_zero(model),
+        .user_block_num = model->user_block_num,
+        .write_page_1 = model->write_page_1,
+        .use_password = model->use_password,
+        .password = model->password,
+        .lock_mask = model->lock_mask,
+    };
+    memcpy(tag.content, model->content, sizeof(tag.content));
+    memcpy(tag.page_1, model->page_1, sizeof(tag.page_1));
+    t5577_plan_build(plan, &tag);
+}
+
 static void t5577_writer_actual_writing(void* model) {
     T5577WriterModel* my_model = (T5577WriterModel*)model;
-    my_model->content[0] = 0; // clear up block 0
-    my_model->content[0] |= my_model->modulation.mod_page_zero;
-    my_model->content[0] |= my_model->rf_clock.clock_page_zero;
-    my_model->content[0] |= (my_model->user_block_num << LFRFID_T5577_MAXBLOCK_SHIFT);
-    LFRFIDT5577* data = (LFRFIDT5577*)malloc(sizeof(LFRFIDT5577));
-    data->blocks_to_write = my_model->user_block_num + 1;
-    for(size_t i = 0; i < data->blocks_to_write; i++) {
-        data->block[i] = my_model->content[i];
+    if(t5577_plan_update(
+           &my_model->plan, &my_model->plan_dirty, t5577_writer_plan_build, my_model)) {
+        FURI_LOG_D(
+            TAG,
+            "Write plan built: %u commands, %u of them locks, %lu us",
+            my_model->plan.command_count,
+            my_model->plan.lock_count,
+            my_model->plan.air_time_us);
     }
-    t5577_write(data);
-    free(data);
+    // Locks are permanent, so they only go out once, after every repeat before has had its go
+    bool last_frame = my_model->writing_repeat_times == MAX_REPEAT_WRITING_FRAMES - 1;
+    t5577_plan_write(&my_model->plan, last_frame);
 }
 
 /**
@@ -538,6 +1155,11 @@ static void t5577_writer_view_write_callback(Canvas* canvas, void* model) {
         canvas_draw_str_aligned(canvas, 97, 15, AlignCenter, AlignTop, "Writing");
         canvas_draw_str_aligned(canvas, 94, 27, AlignCenter, AlignTop, "Hold card next");
         canvas_draw_str_aligned(canvas, 93, 39, AlignCenter, AlignTop, "to Flipper's back");
+        if(my_model->lock_mask) {
+            canvas_set_font(canvas, FontPrimary);
+            canvas_draw_str_aligned(canvas, 93, 51, AlignCenter, AlignTop, "LOCKING!");
+            canvas_set_font(canvas, FontSecondary);
+        }
     } else {
         canvas_set_bitmap_mode(canvas, true);
         canvas_draw_icon(canvas, 0, 9, &I_DolphinSuccess_91x55);
@@ -575,6 +1197,7 @@ static void t5577_writer_view_write_timer_callback(void* context) {
 static void t5577_writer_view_write_enter_callback(void* context) {
     uint32_t repeat_writing_period = furi_ms_to_ticks(200);
     T5577WriterApp* app = (T5577WriterApp*)context;
+    furi_mutex_acquire(app->rf_mutex, FuriWaitForever);
     furi_assert(app->timer == NULL);
     app->timer =
         furi_timer_alloc(t5577_writer_view_write_timer_callback, FuriTimerTypePeriodic, context);
@@ -596,6 +1219,7 @@ static void t5577_writer_view_write_exit_callback(void* context) {
     app->timer = NULL;
     model->writing_repeat_times = 0;
     notification_message(app->notifications, &sequence_blink_stop);
+    furi_mutex_release(app->rf_mutex);
 }
 
 /**
@@ -624,22 +1248,1108 @@ static bool t5577_writer_view_write_custom_event_callback(uint32_t event, void*
     }
 }
 
+/**
+ * @brief      Callback for drawing the raw capture screen.
+ * @param      canvas  The canvas to draw on.
+ * @param      model   The model - T5577WriterCaptureModel object.
+*/
+static void t5577_writer_view_capture_draw_callback(Canvas* canvas, void* model) {
+    T5577WriterCaptureModel* my_model = (T5577WriterCaptureModel*)model;
+    canvas_set_font(canvas, FontPrimary);
+    switch(my_model->state) {
+    case T5577WriterCaptureStateCapturing:
+        canvas_draw_str_aligned(
+            canvas,
+            64,
+            4,
+            AlignCenter,
+            AlignTop,
+            my_model->psk ? "Capturing PSK" : "Capturing ASK");
+        canvas_set_font(canvas, FontSecondary);
+        canvas_draw_str_aligned(canvas, 64, 22, AlignCenter, AlignTop, "Hold card next");
+        canvas_draw_str_aligned(canvas, 64, 34, AlignCenter, AlignTop, "to Flipper's back");
+        break;
+    case T5577WriterCaptureStateDone:
+        canvas_draw_str_aligned(canvas, 64, 4, AlignCenter, AlignTop, "Saved");
+        canvas_set_font(canvas, FontSecondary);
+        canvas_draw_str_aligned(canvas, 64, 22, AlignCenter, AlignTop, my_model->file_name);
+        canvas_draw_str_aligned(canvas, 64, 34, AlignCenter, AlignTop, "in apps_data");
+        break;
+    case T5577WriterCaptureStateError:
+        canvas_draw_str_aligned(canvas, 64, 4, AlignCenter, AlignTop, "Capture Failed");
+        canvas_set_font(canvas, FontSecondary);
+        canvas_draw_str_aligned(canvas, 64, 22, AlignCenter, AlignTop, "Couldn't write the file");
+        break;
+    case T5577WriterCaptureStateOverrun:
+        canvas_draw_str_aligned(canvas, 64, 4, AlignCenter, AlignTop, "Capture Failed");
+        canvas_set_font(canvas, FontSecondary);
+        canvas_draw_str_aligned(canvas, 64, 22, AlignCenter, AlignTop, "Samples were dropped");
+        canvas_draw_str_aligned(canvas, 64, 34, AlignCenter, AlignTop, "Check the SD card");
+        break;
+    }
+}
+
+/**
+ * @brief      Callback from the LF RFID worker thread while capturing.
+ * @details    Only called when something went wrong, so we forward it to the view dispatcher.
+ * @param      result   The LFRFIDWorkerReadRawResult value.
+ * @param      context  The context - T5577WriterApp object.
+*/
+static void t5577_writer_capture_worker_callback(LFRFIDWorkerReadRawResult result, void* context) {
+    T5577WriterApp* app = (T5577WriterApp*)context;
+    if(result == LFRFIDWorkerReadRawOverrun) {
+        view_dispatcher_send_custom_event(app->view_dispatcher, T5577WriterEventIdCaptureOverrun);
+    } else {
+        view_dispatcher_send_custom_event(app->view_dispatcher, T5577WriterEventIdCaptureError);
+    }
+}
+
+static void t5577_writer_capture_timer_callback(void* context) {
+    T5577WriterApp* app = (T5577WriterApp*)context;
+    view_dispatcher_send_custom_event(app->view_dispatcher, T5577WriterEventIdCaptureDone);
+}
+
+/**
+ * @brief      Start streaming the raw envelope to the SD card.
+ * @details    The LF RFID worker captures the envelope with DMA into a pair of buffers and streams
+ *           them to the file while the other buffer fills, so nothing is dropped as long as the SD
+ *           card keeps up.  The timer calls back once after duration_ms; stop it from there.  With no
+ *           callback there is no timer, and the caller stops it.
+ * @param      app          The T5577WriterApp object.
+ * @param      path         The .raw file to write.
+ * @param      psk          Capture with the PSK excitation (62.5 kHz) instead of the ASK one.
+ * @param      callback     Called from the timer thread when the time is up, or NULL.
+ * @param      duration_ms  How long to record for.
+*/
+static void t5577_writer_raw_read_start(
+    T5577WriterApp* app,
+    const char* path,
+    bool psk,
+    FuriTimerCallback callback,
+    uint32_t duration_ms) {
+    app->capture_dict = protocol_dict_alloc(lfrfid_protocols, LFRFIDProtocolMax);
+    app->capture_worker = lfrfid_worker_alloc(app->capture_dict);
+    lfrfid_worker_start_thread(app->capture_worker);
+    lfrfid_worker_read_raw_start(
+        app->capture_worker,
+        path,
+        psk ? LFRFIDWorkerReadTypePSKOnly : LFRFIDWorkerReadTypeASKOnly,
+        t5577_writer_capture_worker_callback,
+        app);
+
+    if(callback == NULL) return;
+    furi_assert(app->timer == NULL);
+    app->timer = furi_timer_alloc(callback, FuriTimerTypeOnce, app);
+    furi_timer_start(app->timer, furi_ms_to_ticks(duration_ms));
+}
+
+/**
+ * @brief      Stop streaming the raw envelope.
+ * @details    The worker thread is joined, so the file is closed once this returns.
+ * @param      app  The T5577WriterApp object.
+*/
+static void t5577_writer_raw_read_stop(T5577WriterApp* app) {
+    if(app->timer) {
+        furi_timer_stop(app->timer);
+        furi_timer_free(app->timer);
+        app->timer = NULL;
+    }
+    if(app->capture_worker) {
+        lfrfid_worker_stop(app->capture_worker);
+        lfrfid_worker_stop_thread(app->capture_worker);
+        lfrfid_worker_free(app->capture_worker);
+        app->capture_worker = NULL;
+        protocol_dict_free(app->capture_dict);
+        app->capture_dict = NULL;
+    }
+}
+
+static void t5577_writer_capture_stop(T5577WriterApp* app) {
+    if(app->capture_worker) notification_message(app->notifications, &sequence_blink_stop);
+    t5577_writer_raw_read_stop(app);
+}
+
+/**
+ * @brief      Start one half of the raw capture.
+ * @details    The half is written to "<tag name>_capture.<ask|psk>.raw" and stops after
+ *           CAPTURE_DURATION_MS.
+ * @param      app  The T5577WriterApp object.
+ * @param      psk  Capture with the PSK excitation (62.5 kHz) instead of the ASK one (125 kHz).
+*/
+static void t5577_writer_capture_start(T5577WriterApp* app, bool psk) {
+    T5577WriterCaptureModel* model = view_get_model(app->view_capture);
+    model->psk = psk;
+    FuriString* file_path = furi_string_alloc();
+    furi_string_printf(
+        file_path,
+        "%s/%s.%s.raw",
+        STORAGE_APP_DATA_PATH_PREFIX,
+        model->file_name,
+        psk ? "psk" : "ask");
+    t5577_writer_raw_read_start(
+        app,
+        furi_string_get_cstr(file_path),
+        psk,
+        t5577_writer_capture_timer_callback,
+        CAPTURE_DURATION_MS);
+    furi_string_free(file_path);
+    notification_message(app->notifications, &sequence_blink_start_cyan);
+}
+
+/**
+ * @brief      Callback when the user starts the raw capture screen.
+ * @details    Both an ASK and a PSK capture are taken, whatever the configured modulation is, so
+ *           Detect never depends on the configuration it is meant to find.  ASK goes first.
+ * @param      context  The context - T5577WriterApp object.
+*/
+static void t5577_writer_view_capture_enter_callback(void* context) {
+    T5577WriterApp* app = (T5577WriterApp*)context;
+    T5577WriterModel* write_model = view_get_model(app->view_write);
+    T5577WriterCaptureModel* model = view_get_model(app->view_capture);
+    model->state = T5577WriterCaptureStateCapturing;
+    snprintf(
+        model->file_name,
+        sizeof(model->file_name),
+        "%s_capture",
+        furi_string_get_cstr(write_model->tag_name_str));
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_mkdir(storage, STORAGE_APP_DATA_PATH_PREFIX);
+    furi_record_close(RECORD_STORAGE);
+
+    furi_mutex_acquire(app->rf_mutex, FuriWaitForever);
+    t5577_writer_capture_start(app, false);
+    dolphin_deed(DolphinDeedRfidRead);
+}
+
+/**
+ * @brief      Callback when the user exits the raw capture screen.
+ * @details    Stops the capture if it is still running.  The partial file is left on the SD card.
+ * @param      context  The context - T5577WriterApp object.
+*/
+static void t5577_writer_view_capture_exit_callback(void* context) {
+    T5577WriterApp* app = (T5577WriterApp*)context;
+    t5577_writer_capture_stop(app);
+    furi_mutex_release(app->rf_mutex);
+}
+
+/**
+ * @brief      Callback for custom events on the raw capture screen.
+ * @details    When the capture is done, the tag that was in use is saved next to it as
+ *           "<tag name>_capture.t5577" so the capture can be matched to its content and config.
+ * @param      event    The event id - T5577WriterEventId value.
+ * @param      context  The context - T5577WriterApp object.
+*/
+static bool t5577_writer_view_capture_custom_event_callback(uint32_t event, void* context) {
+    T5577WriterApp* app = (T5577WriterApp*)context;
+    T5577WriterCaptureModel* model = view_get_model(app->view_capture);
+    T5577WriterCaptureState state;
+    switch(event) {
+    case T5577WriterEventIdCaptureDone: {
+        t5577_writer_capture_stop(app);
+        if(!model->psk) {
+            t5577_writer_capture_start(app, true); // ASK is done, PSK is next
+            state = T5577WriterCaptureStateCapturing;
+            break;
+        }
+        FuriString* file_path = furi_string_alloc();
+        furi_string_printf(
+            file_path,
+            "%s/%s%s",
+            STORAGE_APP_DATA_PATH_PREFIX,
+            model->file_name,
+            T5577_WRITER_FILE_EXTENSION);
+        bool saved = t5577_writer_save_file(app, furi_string_get_cstr(file_path));
+        furi_string_free(file_path);
+        state = saved ? T5577WriterCaptureStateDone : T5577WriterCaptureStateError;
+        notification_message(app->notifications, saved ? &sequence_success : &sequence_error);
+        break;
+    }
+    case T5577WriterEventIdCaptureError:
+        t5577_writer_capture_stop(app);
+        state = T5577WriterCaptureStateError;
+        notification_message(app->notifications, &sequence_error);
+        break;
+    case T5577WriterEventIdCaptureOverrun:
+        t5577_writer_capture_stop(app);
+        state = T5577WriterCaptureStateOverrun;
+        notification_message(app->notifications, &sequence_error);
+        break;
+    default:
+        return false;
+    }
+    bool redraw = true;
+    with_view_model(
+        app->view_capture, T5577WriterCaptureModel * model, { model->state = state; }, redraw);
+    return true;
+}
+
+/**
+ * @brief      Read a fixed size struct from the SD card.
+ * @param      path  The file to read.
+ * @param      data  Where to put the struct.
+ * @param      size  The size of the struct.
+ * @return     true if the whole struct was read.
+*/
+static bool t5577_writer_raw_file_read(const char* path, void* data, size_t size) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool loaded = false;
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        loaded = storage_file_read(file, data, size) == size;
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return loaded;
+}
+
+/**
+ * @brief      Write a fixed size struct to the SD card, replacing the file.
+ * @param      path  The file to write.
+ * @param      data  The struct to write.
+ * @param      size  The size of the struct.
+*/
+static void t5577_writer_raw_file_write(const char* path, const void* data, size_t size) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_mkdir(storage, STORAGE_APP_DATA_PATH_PREFIX);
+    File* file = storage_file_alloc(storage);
+    if(!storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS) ||
+       storage_file_write(file, data, size) != size) {
+        FURI_LOG_E(TAG, "Failed to write %s", path);
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+/**
+ * @brief      Parse one line of the password dictionary.
+ * @details    A line is either a single hex password ("51243648") or an inclusive hex range
+ *           ("00000000-0000FFFF").  A single password is returned as a range of one.  Blank lines
+ *           and lines starting with '#' are skipped.
+ * @param      line   The line to parse.
+ * @param      first  Where to put the first password of the line.
+ * @param      last   Where to put the last password of the line.
+ * @return     true if the line holds any passwords.
+*/
+static bool t5577_writer_recover_parse_line(FuriString* line, uint32_t* first, uint32_t* last) {
+    furi_string_trim(line);
+    const char* str = furi_string_get_cstr(line);
+    if(str[0] == '\0' || str[0] == '#') return false;
+    char* end;
+    *first = strtoul(str, &end, 16);
+    if(end == str) return false;
+    *last = *first;
+    if(*end == '-') {
+        const char* last_str = end + 1;
+        *last = strtoul(last_str, &end, 16);
+        if(end == last_str || *last < *first) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief      Get the next password candidate.
+ * @details    Candidates come from the current range first, then from the next dictionary line.
+ * @param      app       The T5577WriterApp object.
+ * @param      password  Where to put the candidate.
+ * @return     false once the dictionary is exhausted.
+*/
+static bool t5577_writer_recover_next(T5577WriterApp* app, uint32_t* password) {
+    FuriString* line = furi_string_alloc();
+    bool found = false;
+    while(!found) {
+        if(app->recover_in_range) {
+            *password = app->recover_range_next;
+            if(app->recover_range_next == app->recover_range_end) {
+                app->recover_in_range = false;
+            } else {
+                app->recover_range_next++;
+            }
+            found = true;
+        } else {
+            if(!stream_read_line(app->recover_stream, line)) break;
+            uint32_t first, last;
+            if(t5577_writer_recover_parse_line(line, &first, &last)) {
+                app->recover_range_next = first;
+                app->recover_range_end = last;
+                app->recover_in_range = true;
+            }
+        }
+    }
+    furi_string_free(line);
+    return found;
+}
+
+/**
+ * @brief      Hash the whole dictionary with FNV-1a and rewind it.
+ * @param      app  The T5577WriterApp object.
+*/
+static void t5577_writer_recover_dict_hash(T5577WriterApp* app) {
+    uint8_t buffer[64];
+    uint32_t hash = 0x811C9DC5;
+    size_t read;
+    stream_rewind(app->recover_stream);
+    while((read = stream_read(app->recover_stream, buffer, sizeof(buffer))) > 0) {
+        for(size_t i = 0; i < read; i++) {
+            hash = (hash ^ buffer[i]) * 0x01000193;
+        }
+    }
+    stream_rewind(app->recover_stream);
+    app->recover_dict_size = stream_size(app->recover_stream);
+    app->recover_dict_hash = hash;
+}
+
+/**
+ * @brief      Remember the dictionary position as the place to resume from.
+ * @details    Taken before a batch is read from the dictionary, so a run that is stopped while a
+ *           batch is out, or while its hit is narrowed down, tries the whole batch again.
+ * @param      app  The T5577WriterApp object.
+*/
+static void t5577_writer_recover_checkpoint_mark(T5577WriterApp* app) {
+    T5577WriterRecoverModel* model = view_get_model(app->view_recover);
+    T5577WriterRecoverCheckpoint* checkpoint = &app->recover_checkpoint;
+    memset(checkpoint, 0, sizeof(T5577WriterRecoverCheckpoint));
+    checkpoint->magic = T5577_WRITER_RECOVER_MAGIC;
+    checkpoint->version = T5577_WRITER_RECOVER_VERSION;
+    checkpoint->in_range = app->recover_in_range;
+    checkpoint->stream_offset = stream_tell(app->recover_stream);
+    checkpoint->range_next = app->recover_range_next;
+    checkpoint->range_end = app->recover_range_end;
+    checkpoint->attempts = model->attempts;
+    checkpoint->dict_size = app->recover_dict_size;
+    checkpoint->dict_hash = app->recover_dict_hash;
+}
+
+static void t5577_writer_recover_checkpoint_save(T5577WriterApp* app) {
+    t5577_writer_raw_file_write(
+        T5577_WRITER_RECOVER_CHECKPOINT_PATH,
+        &app->recover_checkpoint,
+        sizeof(T5577WriterRecoverCheckpoint));
+}
+
+static void t5577_writer_recover_checkpoint_load(T5577WriterApp* app) {
+    T5577WriterRecoverModel* model = view_get_model(app->view_recover);
+    T5577WriterRecoverCheckpoint checkpoint;
+    if(!t5577_writer_raw_file_read(
+           T5577_WRITER_RECOVER_CHECKPOINT_PATH, &checkpoint, sizeof(checkpoint)) ||
+       checkpoint.magic != T5577_WRITER_RECOVER_MAGIC ||
+       checkpoint.version != T5577_WRITER_RECOVER_VERSION) {
+        return;
+    }
+    if(checkpoint.dict_size != app->recover_dict_size ||
+       checkpoint.dict_hash != app->recover_dict_hash) {
+        FURI_LOG_W(TAG, "The dictionary changed since the last run, starting over");
+        return;
+    }
+    if(!stream_seek(app->recover_stream, checkpoint.stream_offset, StreamOffsetFromStart)) {
+        stream_rewind(app->recover_stream);
+        return;
+    }
+    app->recover_in_range = checkpoint.in_range;
+    app->recover_range_next = checkpoint.range_next;
+    app->recover_range_end = checkpoint.range_end;
+    model->attempts = checkpoint.attempts;
+    FURI_LOG_I(TAG, "Resuming password recovery after %lu attempts", checkpoint.attempts);
+}
+
+/**
+ * @brief      Block 0 the final write sends: the configured one, without the password bit.
+ * @param      model  The T5577WriterModel object.
+ * @return     The block 0 data.
+*/
+static uint32_t t5577_writer_recover_block_zero(T5577WriterModel* model) {
+    return t5577_writer_block_zero(model) & ~LFRFID_T5577_PWD;
+}
+
+/**
+ * @brief      Block 0 of a probe config.
+ * @details    The configured block 0 at another RF clock, with the password bit, so the tag keeps
+ *           asking for the password while a hit is narrowed down.
+ * @param      model           The T5577WriterModel object.
+ * @param      rf_clock_index  The index into all_rf_clocks the tag should reply at.
+ * @return     The block 0 data.
+*/
+static uint32_t t5577_writer_recover_probe(T5577WriterModel* model, uint8_t rf_clock_index) {
+    uint32_t block_zero = t5577_writer_block_zero(model) & ~T5577_WRITER_BITRATE_MASK;
+    return block_zero | all_rf_clocks[rf_clock_index].clock_page_zero | LFRFID_T5577_PWD;
+}
+
+static uint8_t t5577_writer_recover_other_clock(uint8_t rf_clock_index) {
+    return rf_clock_index == RECOVER_PROBE_CLOCK ? RECOVER_PROBE_CLOCK_ALT : RECOVER_PROBE_CLOCK;
+}
+
+static void t5577_writer_recover_read_timer_callback(void* context) {
+    T5577WriterApp* app = (T5577WriterApp*)context;
+    view_dispatcher_send_custom_event(app->view_dispatcher, T5577WriterEventIdRecoverRead);
+}
+
+/**
+ * @brief      Record the tag's reply for REPLY_READ_MS.
+ * @details    Turning the field back on resets the tag, so it replies with the last block 0 it took.
+ * @param      app  The T5577WriterApp object.
+*/
+static void t5577_writer_recover_read_start(T5577WriterApp* app) {
+    t5577_writer_raw_read_start(
+        app,
+        T5577_WRITER_REPLY_PATH,
+        false,
+        t5577_writer_recover_read_timer_callback,
+        REPLY_READ_MS);
+}
+
+/**
+ * @brief      Find the RF clock of the reply recorded to T5577_WRITER_REPLY_PATH.
+ * @return     The index into all_rf_clocks, or CLOCK_NUM if there was no clear reply.
+*/
+static uint8_t t5577_writer_reply_clock(void) {
+    T5577Detect* detect = t5577_detect_alloc();
+    T5577DetectResult result;
+    uint32_t pairs;
+    uint8_t rf_clock_index = CLOCK_NUM;
+    if(t5577_writer_detect_read_file(detect, T5577_WRITER_REPLY_PATH, &pairs) &&
+       t5577_detect_result(detect, &result) && result.confidence >= REPLY_MIN_CONFIDENCE) {
+        rf_clock_index = result.rf_clock_index;
+    }
+    t5577_detect_free(detect);
+    return rf_clock_index;
+}
+
+/**
+ * @brief      Write the next few candidates of the current send.
+ * @details    A send is a whole batch from the dictionary, or a part of it while a hit is narrowed
+ *           down.  Every candidate goes out as a password write of block 0 with the send's probe
+ *           config.  RECOVER_BATCH_ATTEMPTS are written per custom event so Back isn't held up, and
+ *           once the whole send is out the tag's reply is recorded.
+ * @param      app  The T5577WriterApp object.
+*/
+static void t5577_writer_recover_send(T5577WriterApp* app) {
+    T5577Recover* recover = &app->recover;
+    LFRFIDT5577 data;
+    memset(&data, 0, sizeof(data));
+    data.block[0] = app->recover_probes[recover->probe];
+    data.blocks_to_write = 1;
+    for(uint8_t i = 0; i < RECOVER_BATCH_ATTEMPTS && app->recover_sent < recover->count; i++) {
+        t5577_write_with_pass(&data, recover->candidates[recover->first + app->recover_sent++]);
+    }
+    if(app->recover_sent < recover->count) {
+        view_dispatcher_send_custom_event(app->view_dispatcher, T5577WriterEventIdRecoverBatch);
+    } else {
+        t5577_writer_recover_read_start(app);
+    }
+}
+
+static void t5577_writer_recover_set_state(T5577WriterApp* app, T5577WriterRecoverState state) {
+    bool redraw = true;
+    with_view_model(
+        app->view_recover, T5577WriterRecoverModel * model, { model->state = state; }, redraw);
+}
+
+/**
+ * @brief      End the run.
+ * @details    The checkpoint is removed once the password is known or the dictionary is done.
+ *           Otherwise it is saved, so the next run starts again from the batch with the hit.
+ * @param      app    The T5577WriterApp object.
+ * @param      state  The state to show.
+*/
+static void t5577_writer_recover_stop(T5577WriterApp* app, T5577WriterRecoverState state) {
+    app->recover_running = false;
+    if(state == T5577WriterRecoverStateLost) {
+        t5577_writer_recover_checkpoint_save(app);
+    } else {
+        Storage* storage = furi_record_open(RECORD_STORAGE);
+        storage_simply_remove(storage, T5577_WRITER_RECOVER_CHECKPOINT_PATH);
+        furi_record_close(RECORD_STORAGE);
+    }
+    t5577_writer_recover_set_state(app, state);
+    notification_message(app->notifications, &sequence_blink_stop);
+    furi_mutex_release(app->rf_mutex);
+    notification_message(
+        app->notifications,
+        state == T5577WriterRecoverStateFound ? &sequence_success : &sequence_error);
+}
+
+/**
+ * @brief      Take the next batch from the dictionary and start sending it with probe 0.
+ * @param      app  The T5577WriterApp object.
+*/
+static void t5577_writer_recover_next_batch(T5577WriterApp* app) {
+    T5577Recover* recover = &app->recover;
+    t5577_writer_recover_checkpoint_mark(app);
+    if(++app->recover_batches >= RECOVER_CHECKPOINT_BATCHES) {
+        app->recover_batches = 0;
+        t5577_writer_recover_checkpoint_save(app);
+    }
+
+    uint8_t count = 0;
+    while(count < T5577_RECOVER_BATCH_SIZE &&
+          t5577_writer_recover_next(app, &recover->candidates[count])) {
+        count++;
+    }
+    if(count == 0) {
+        t5577_writer_recover_stop(app, T5577WriterRecoverStateFinished);
+        return;
+    }
+    t5577_recover_batch(recover, count);
+    app->recover_sent = 0;
+
+    bool redraw = true;
+    with_view_model(
+        app->view_recover,
+        T5577WriterRecoverModel * model,
+        {
+            model->attempts += count;
+            model->candidate = recover->candidates[count - 1];
+        },
+        redraw);
+    t5577_writer_recover_send(app);
+}
+
+/**
+ * @brief      Pick the probe configs from how the tag replies before anything is sent.
+ * @details    Probe 0 is the configured RF clock, unless the tag already replies at it: a batch
+ *           with a hit has to change the reply.  Probe 1 only has to differ from probe 0.
+ * @param      app             The T5577WriterApp object.
+ * @param      rf_clock_index  The RF clock the tag replies at, CLOCK_NUM if it doesn't.
+*/
+static void t5577_writer_recover_pick_probes(T5577WriterApp* app, uint8_t rf_clock_index) {
+    T5577WriterModel* write_model = view_get_model(app->view_write);
+    uint8_t probe_clock = write_model->rf_clock_index;
+    if(probe_clock == rf_clock_index) probe_clock = t5577_writer_recover_other_clock(probe_clock);
+    app->recover_probe_clocks[0] = probe_clock;
+    app->recover_probe_clocks[1] = t5577_writer_recover_other_clock(probe_clock);
+    for(uint8_t i = 0; i < 2; i++) {
+        app->recover_probes[i] =
+            t5577_writer_recover_probe(write_model, app->recover_probe_clocks[i]);
+    }
+    if(rf_clock_index < CLOCK_NUM) {
+        FURI_LOG_I(TAG, "Tag replies at RF/%u", all_rf_clocks[rf_clock_index].rf_clock_num);
+    } else {
+        FURI_LOG_I(TAG, "No reply from the tag");
+    }
+    FURI_LOG_I(
+        TAG,
+        "Probing at RF/%u and RF/%u",
+        all_rf_clocks[app->recover_probe_clocks[0]].rf_clock_num,
+        all_rf_clocks[app->recover_probe_clocks[1]].rf_clock_num);
+}
+
+/**
+ * @brief      Act on the tag's reply after a send.
+ * @details    A batch with a hit leaves the tag replying at probe 0's RF clock.  The batch is then
+ *           halved with the probes swapped until one candidate is left.  That one is sent once more
+ *           with the probe the tag isn't on, and only if that takes too is it the password: the
+ *           configured block 0 is then written with it and the password is shown.
+ * @param      app  The T5577WriterApp object.
+*/
+static void t5577_writer_recover_read_done(T5577WriterApp* app) {
+    T5577WriterRecoverModel* model = view_get_model(app->view_recover);
+    T5577Recover* recover = &app->recover;
+    t5577_writer_raw_read_stop(app);
+    uint8_t rf_clock_index = t5577_writer_reply_clock();
+    bool took = rf_clock_index == app->recover_probe_clocks[recover->probe];
+    switch(model->state) {
+    case T5577WriterRecoverStateReading:
+        t5577_writer_recover_pick_probes(app, rf_clock_index);
+        t5577_writer_recover_set_state(app, T5577WriterRecoverStateRunning);
+        t5577_writer_recover_next_batch(app);
+        return;
+    case T5577WriterRecoverStateRunning:
+    case T5577WriterRecoverStateNarrowing:
+        t5577_recover_result(recover, took);
+        break;
+    case T5577WriterRecoverStateVerifying:
+        if(took) {
+            T5577WriterModel* write_model = view_get_model(app->view_write);
+            LFRFIDT5577 data;
+            memset(&data, 0, sizeof(data));
+            data.block[0] = t5577_writer_recover_block_zero(write_model);
+            data.blocks_to_write = 1;
+            t5577_write_with_pass(&data, model->candidate);
+            FURI_LOG_I(TAG, "Password is %08lX", model->candidate);
+            t5577_writer_recover_stop(app, T5577WriterRecoverStateFound);
+        } else {
+            FURI_LOG_W(TAG, "%08lX didn't take again", model->candidate);
+            t5577_writer_recover_stop(app, T5577WriterRecoverStateLost);
+        }
+        return;
+    default:
+        return;
+    }
+
+    app->recover_sent = 0;
+    switch(recover->step) {
+    case T5577RecoverStepSearch:
+        t5577_writer_recover_next_batch(app);
+        break;
+    case T5577RecoverStepBisect:
+        t5577_writer_recover_set_state(app, T5577WriterRecoverStateNarrowing);
+        t5577_writer_recover_send(app);
+        break;
+    case T5577RecoverStepFound:
+        model->candidate = recover->candidates[recover->first];
+        t5577_writer_recover_set_state(app, T5577WriterRecoverStateVerifying);
+        t5577_writer_recover_send(app);
+        break;
+    }
+}
+
+/**
+ * @brief      Ask whether to resume from the checkpoint or start over.
+ * @details    The checkpoint only knows the dictionary, not the tag, so the user says if it is the
+ *           same tag.  Restart removes the checkpoint.  Nothing is asked without a checkpoint.
+ * @param      app  The T5577WriterApp object.
+ * @return     false if the user backed out.
+*/
+static bool t5577_writer_recover_ask_resume(T5577WriterApp* app) {
+    T5577WriterRecoverCheckpoint checkpoint;
+    if(!t5577_writer_raw_file_read(
+           T5577_WRITER_RECOVER_CHECKPOINT_PATH, &checkpoint, sizeof(checkpoint)) ||
+       checkpoint.magic != T5577_WRITER_RECOVER_MAGIC ||
+       checkpoint.version != T5577_WRITER_RECOVER_VERSION) {
+        return true;
+    }
+    FuriString* text = furi_string_alloc();
+    furi_string_printf(
+        text, "The last run stopped\nafter %lu tries.\nSame tag?", checkpoint.attempts);
+    DialogMessage* message = dialog_message_alloc();
+    dialog_message_set_header(message, "Resume?", 64, 0, AlignCenter, AlignTop);
+    dialog_message_set_text(
+        message, furi_string_get_cstr(text), 64, 30, AlignCenter, AlignCenter);
+    dialog_message_set_buttons(message, "Restart", NULL, "Resume");
+    DialogMessageButton button = dialog_message_show(app->dialogs, message);
+    dialog_message_free(message);
+    furi_string_free(text);
+    if(button == DialogMessageButtonLeft) {
+        Storage* storage = furi_record_open(RECORD_STORAGE);
+        storage_simply_remove(storage, T5577_WRITER_RECOVER_CHECKPOINT_PATH);
+        furi_record_close(RECORD_STORAGE);
+    }
+    return button != DialogMessageButtonBack;
+}
+
+/**
+ * @brief      Show what 'Clear Password' writes and ask before starting.
+ * @details    If an earlier run left a checkpoint, whether to resume it is asked next.
+ * @param      app  The T5577WriterApp object.
+ * @return     true if the user chose to start.
+*/
+static bool t5577_writer_recover_confirm(T5577WriterApp* app) {
+    T5577WriterModel* model = view_get_model(app->view_write);
+    FuriString* text = furi_string_alloc();
+    furi_string_printf(
+        text,
+        "Block 0: %08lX\n%s RF/%u\nNo password",
+        t5577_writer_recover_block_zero(model),
+        model->modulation.modulation_name,
+        model->rf_clock.rf_clock_num);
+    DialogMessage* message = dialog_message_alloc();
+    dialog_message_set_header(message, "Clear Password?", 64, 0, AlignCenter, AlignTop);
+    dialog_message_set_text(
+        message, furi_string_get_cstr(text), 64, 30, AlignCenter, AlignCenter);
+    dialog_message_set_buttons(message, "Back", NULL, "Start");
+    DialogMessageButton button = dialog_message_show(app->dialogs, message);
+    dialog_message_free(message);
+    furi_string_free(text);
+    if(button != DialogMessageButtonRight) return false;
+    return t5577_writer_recover_ask_resume(app);
+}
+
+/**
+ * @brief      Callback for drawing the password clearing screen.
+ * @param      canvas  The canvas to draw on.
+ * @param      model   The model - T5577WriterRecoverModel object.
+*/
+static void t5577_writer_view_recover_draw_callback(Canvas* canvas, void* model) {
+    T5577WriterRecoverModel* my_model = (T5577WriterRecoverModel*)model;
+    FuriString* buffer = furi_string_alloc();
+    canvas_set_font(canvas, FontPrimary);
+    switch(my_model->state) {
+    case T5577WriterRecoverStateReading:
+        canvas_draw_str_aligned(canvas, 64, 4, AlignCenter, AlignTop, "Reading Tag");
+        canvas_set_font(canvas, FontSecondary);
+        canvas_draw_str_aligned(canvas, 64, 50, AlignCenter, AlignTop, "Hold card next to back");
+        break;
+    case T5577WriterRecoverStateRunning:
+        canvas_draw_str_aligned(canvas, 64, 4, AlignCenter, AlignTop, "Clearing Password");
+        canvas_set_font(canvas, FontSecondary);
+        furi_string_printf(buffer, "Tried: %lu", my_model->attempts);
+        canvas_draw_str_aligned(
+            canvas, 64, 22, AlignCenter, AlignTop, furi_string_get_cstr(buffer));
+        furi_string_printf(buffer, "Last: %08lX", my_model->candidate);
+        canvas_draw_str_aligned(
+            canvas, 64, 34, AlignCenter, AlignTop, furi_string_get_cstr(buffer));
+        canvas_draw_str_aligned(canvas, 64, 50, AlignCenter, AlignTop, "Hold card next to back");
+        break;
+    case T5577WriterRecoverStateNarrowing:
+    case T5577WriterRecoverStateVerifying:
+        canvas_draw_str_aligned(canvas, 64, 4, AlignCenter, AlignTop, "Got a Hit");
+        canvas_set_font(canvas, FontSecondary);
+        if(my_model->state == T5577WriterRecoverStateNarrowing) {
+            furi_string_set_str(buffer, "Finding which one...");
+        } else {
+            furi_string_printf(buffer, "Checking %08lX", my_model->candidate);
+        }
+        canvas_draw_str_aligned(
+            canvas, 64, 28, AlignCenter, AlignTop, furi_string_get_cstr(buffer));
+        canvas_draw_str_aligned(canvas, 64, 50, AlignCenter, AlignTop, "Hold card next to back");
+        break;
+    case T5577WriterRecoverStateFound:
+        canvas_draw_str_aligned(canvas, 64, 4, AlignCenter, AlignTop, "Password Cleared!");
+        canvas_set_font(canvas, FontSecondary);
+        furi_string_printf(buffer, "It was %08lX", my_model->candidate);
+        canvas_draw_str_aligned(
+            canvas, 64, 22, AlignCenter, AlignTop, furi_string_get_cstr(buffer));
+        furi_string_printf(buffer, "after %lu tries", my_model->attempts);
+        canvas_draw_str_aligned(
+            canvas, 64, 34, AlignCenter, AlignTop, furi_string_get_cstr(buffer));
+        break;
+    case T5577WriterRecoverStateLost:
+        canvas_draw_str_aligned(canvas, 64, 4, AlignCenter, AlignTop, "Lost the Hit");
+        canvas_set_font(canvas, FontSecondary);
+        canvas_draw_str_aligned(
+            canvas, 64, 22, AlignCenter, AlignTop, "Keep the card still and");
+        canvas_draw_str_aligned(
+            canvas, 64, 34, AlignCenter, AlignTop, "run it again to retry");
+        break;
+    case T5577WriterRecoverStateFinished:
+        canvas_draw_str_aligned(canvas, 64, 4, AlignCenter, AlignTop, "No Match");
+        canvas_set_font(canvas, FontSecondary);
+        furi_string_printf(buffer, "Tried: %lu", my_model->attempts);
+        canvas_draw_str_aligned(
+            canvas, 64, 22, AlignCenter, AlignTop, furi_string_get_cstr(buffer));
+        canvas_draw_str_aligned(
+            canvas, 64, 38, AlignCenter, AlignTop, "The password isn't in");
+        canvas_draw_str_aligned(canvas, 64, 48, AlignCenter, AlignTop, "the dictionary");
+        break;
+    case T5577WriterRecoverStateNoDictionary:
+        canvas_draw_str_aligned(canvas, 64, 4, AlignCenter, AlignTop, "No Dictionary");
+        canvas_set_font(canvas, FontSecondary);
+        canvas_draw_str_aligned(canvas, 64, 22, AlignCenter, AlignTop, "Put passwords.txt in");
+        canvas_draw_str_aligned(
+            canvas, 64, 34, AlignCenter, AlignTop, "apps_data/t5577_writer");
+        break;
+    }
+    furi_string_free(buffer);
+}
+
+/**
+ * @brief      Callback when the user starts the password clearing screen.
+ * @details    Opens the dictionary, resumes from the last checkpoint and records how the tag replies
+ *           before anything is sent.
+ * @param      context  The context - T5577WriterApp object.
+*/
+static void t5577_writer_view_recover_enter_callback(void* context) {
+    T5577WriterApp* app = (T5577WriterApp*)context;
+    T5577WriterRecoverModel* model = view_get_model(app->view_recover);
+    model->attempts = 0;
+    model->candidate = 0;
+    app->recover_in_range = false;
+    app->recover_batches = 0;
+    t5577_recover_reset(&app->recover);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    app->recover_stream = file_stream_alloc(storage);
+    if(!file_stream_open(
+           app->recover_stream, T5577_WRITER_RECOVER_DICT_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        model->state = T5577WriterRecoverStateNoDictionary;
+        return;
+    }
+    model->state = T5577WriterRecoverStateReading;
+    t5577_writer_recover_dict_hash(app);
+    t5577_writer_recover_checkpoint_load(app);
+    t5577_writer_recover_checkpoint_mark(app);
+
+    furi_mutex_acquire(app->rf_mutex, FuriWaitForever);
+    app->recover_running = true;
+    notification_message(app->notifications, &sequence_blink_start_magenta);
+    t5577_writer_recover_read_start(app);
+}
+
+/**
+ * @brief      Callback when the user exits the password clearing screen.
+ * @details    Stops the read that may be running, saves where the current batch started if the run
+ *           wasn't over and closes the dictionary.
+ * @param      context  The context - T5577WriterApp object.
+*/
+static void t5577_writer_view_recover_exit_callback(void* context) {
+    T5577WriterApp* app = (T5577WriterApp*)context;
+    t5577_writer_raw_read_stop(app);
+    if(app->recover_running) {
+        app->recover_running = false;
+        t5577_writer_recover_checkpoint_save(app);
+        notification_message(app->notifications, &sequence_blink_stop);
+        furi_mutex_release(app->rf_mutex);
+    }
+    file_stream_close(app->recover_stream);
+    stream_free(app->recover_stream);
+    app->recover_stream = NULL;
+    furi_record_close(RECORD_STORAGE);
+}
+
+/**
+ * @brief      Callback for custom events on the password clearing screen.
+ * @param      event    The event id - T5577WriterEventId value.
+ * @param      context  The context - T5577WriterApp object.
+*/
+static bool t5577_writer_view_recover_custom_event_callback(uint32_t event, void* context) {
+    T5577WriterApp* app = (T5577WriterApp*)context;
+    switch(event) {
+    case T5577WriterEventIdRecoverBatch:
+        if(app->recover_running) t5577_writer_recover_send(app);
+        return true;
+    case T5577WriterEventIdRecoverRead:
+        if(app->recover_running) t5577_writer_recover_read_done(app);
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief      Restore the last session from the SD card.
+ * @details    Reads the raw session snapshot written by t5577_writer_session_save.  Anything that
+ *           doesn't look like a snapshot from this version is ignored and the defaults are kept.
+ *           Lock bits are not part of it and always start off.
+ * @param      app  The T5577WriterApp object.
+*/
+static void t5577_writer_session_load(T5577WriterApp* app) {
+    T5577WriterModel* model = view_get_model(app->view_write);
+    T5577WriterSession session;
+    if(!t5577_writer_raw_file_read(T5577_WRITER_SESSION_PATH, &session, sizeof(session)) ||
+       session.magic != T5577_WRITER_SESSION_MAGIC ||
+       session.version != T5577_WRITER_SESSION_VERSION ||
+       session.modulation_index >= COUNT_OF(all_mods) ||
+       session.rf_clock_index >= COUNT_OF(all_rf_clocks) ||
+       session.user_block_num >= LFRFID_T5577_BLOCK_COUNT || session.edit_block_slc == 0 ||
+       session.edit_block_slc >= T5577_WRITER_EDIT_SLOT_COUNT) {
+        return;
+    }
+
+    model->modulation_index = session.modulation_index;
+    model->modulation = all_mods[model->modulation_index];
+    model->rf_clock_index = session.rf_clock_index;
+    model->rf_clock = all_rf_clocks[model->rf_clock_index];
+    model->user_block_num = session.user_block_num;
+    model->edit_block_slc = session.edit_block_slc;
+    memcpy(model->content, session.content, sizeof(model->content));
+    memcpy(model->page_1, session.page_1, sizeof(model->page_1));
+    model->write_page_1 = session.write_page_1;
+    model->use_password = session.use_password;
+    model->password = session.password;
+    session.tag_name[sizeof(session.tag_name) - 1] = '\0';
+    session.file_path[sizeof(session.file_path) - 1] = '\0';
+    furi_string_set_str(model->tag_name_str, session.tag_name);
+    furi_string_set_str(app->file_path, session.file_path);
+}
+
+/**
+ * @brief      Save the current session to the SD card.
+ * @details    The snapshot is a fixed size struct so restoring it on launch is a single read.
+ * @param      app  The T5577WriterApp object.
+*/
+static void t5577_writer_session_save(T5577WriterApp* app) {
+    T5577WriterModel* model = view_get_model(app->view_write);
+    T5577WriterSession session;
+    memset(&session, 0, sizeof(session));
+    session.magic = T5577_WRITER_SESSION_MAGIC;
+    session.version = T5577_WRITER_SESSION_VERSION;
+    session.modulation_index = model->modulation_index;
+    session.rf_clock_index = model->rf_clock_index;
+    session.user_block_num = model->user_block_num;
+    session.edit_block_slc = model->edit_block_slc;
+    memcpy(session.content, model->content, sizeof(session.content));
+    memcpy(session.page_1, model->page_1, sizeof(session.page_1));
+    session.write_page_1 = model->write_page_1;
+    session.use_password = model->use_password;
+    session.password = model->password;
+    strncpy(
+        session.tag_name, furi_string_get_cstr(model->tag_name_str), sizeof(session.tag_name) - 1);
+    strncpy(
+        session.file_path, furi_string_get_cstr(app->file_path), sizeof(session.file_path) - 1);
+
+    t5577_writer_raw_file_write(T5577_WRITER_SESSION_PATH, &session, sizeof(session));
+}
+
+/**
+ * @brief      Parse "<block 0> [<block 1> .. <block 7>]" into a tag to write.
+ * @details    Every block is 8 hex digits.  Blocks after block 0 go to page 0 from block 1 on, with
+ *           no password, page 1 or locks, like a tag configured by hand without those.
+ * @param      args  The arguments after "write".
+ * @param      tag   The tag to fill.
+ * @return     true if the arguments were valid.
+*/
+static bool t5577_writer_cli_parse_tag(FuriString* args, T5577PlanTag* tag) {
+    FuriString* word = furi_string_alloc();
+    uint8_t count = 0;
+    bool valid = true;
+    memset(tag, 0, sizeof(T5577PlanTag));
+    while(valid && args_read_string_and_trim(args, word)) {
+        const char* text = furi_string_get_cstr(word);
+        char* end;
+        uint32_t block = strtoul(text, &end, 16);
+        valid = count < LFRFID_T5577_BLOCK_COUNT && furi_string_size(word) == 8 && *end == '\0';
+        if(!valid) break;
+        if(count == 0) {
+            tag->block_zero = block;
+        } else {
+            tag->content[count] = block;
+        }
+        count++;
+    }
+    furi_string_free(word);
+    if(!valid || count == 0) return false;
+    tag->user_block_num = count - 1;
+    return true;
+}
+
+/**
+ * @brief      Write a tag for a host and check that it replies at the RF clock block 0 asks for.
+ * @details    The plan is sent MAX_REPEAT_WRITING_FRAMES times like the writing screen does, then
+ *           the reply is recorded for REPLY_READ_MS.  Answers one line: "ok RF/<clock> <ms> ms", or
+ *           "error busy" when a screen is using the RF hardware, "error no reply" or
+ *           "error RF/<clock>" when the tag came back with another clock.
+ * @param      app   The T5577WriterApp object.
+ * @param      args  The arguments after "write".
+*/
+static void t5577_writer_cli_write(T5577WriterApp* app, FuriString* args) {
+    T5577PlanTag tag;
+    if(!t5577_writer_cli_parse_tag(args, &tag)) {
+        printf("error usage\r\n");
+        return;
+    }
+    if(furi_mutex_acquire(app->rf_mutex, 0) != FuriStatusOk) {
+        printf("error busy\r\n");
+        return;
+    }
+    uint32_t start_tick = furi_get_tick();
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_mkdir(storage, STORAGE_APP_DATA_PATH_PREFIX);
+    furi_record_close(RECORD_STORAGE);
+
+    T5577Plan plan;
+    t5577_plan_build(&plan, &tag);
+    for(uint8_t i = 0; i < MAX_REPEAT_WRITING_FRAMES; i++) {
+        t5577_plan_write(&plan, false);
+    }
+    t5577_writer_raw_read_start(app, T5577_WRITER_REPLY_PATH, false, NULL, REPLY_READ_MS);
+    furi_delay_ms(REPLY_READ_MS);
+    t5577_writer_raw_read_stop(app);
+    uint8_t rf_clock_index = t5577_writer_reply_clock();
+    furi_mutex_release(app->rf_mutex);
+
+    uint32_t expected = tag.block_zero & T5577_WRITER_BITRATE_MASK;
+    if(rf_clock_index == CLOCK_NUM) {
+        printf("error no reply\r\n");
+    } else if(all_rf_clocks[rf_clock_index].clock_page_zero != expected) {
+        printf("error RF/%u\r\n", all_rf_clocks[rf_clock_index].rf_clock_num);
+    } else {
+        printf(
+            "ok RF/%u %lu ms\r\n",
+            all_rf_clocks[rf_clock_index].rf_clock_num,
+            furi_get_tick() - start_tick);
+    }
+}
+
+/**
+ * @brief      The "t5577" CLI command, so a host can drive the app over USB serial.
+ * @details    Runs on the CLI thread while the app is open.  Only "write" is known for now; see
+ *           t5577_writer_cli_write for the reply.
+ * @param      cli      The CLI, unused.
+ * @param      args     The arguments after "t5577".
+ * @param      context  The context - T5577WriterApp object.
+*/
+static void t5577_writer_cli(Cli* cli, FuriString* args, void* context) {
+    UNUSED(cli);
+    T5577WriterApp* app = (T5577WriterApp*)context;
+    FuriString* command = furi_string_alloc();
+    if(args_read_string_and_trim(args, command) &&
+       strcmp(furi_string_get_cstr(command), "write") == 0) {
+        t5577_writer_cli_write(app, args);
+    } else {
+        printf("error usage\r\n");
+    }
+    furi_string_free(command);
+}
+
+/**
+ * @brief      Called by the GUI every time a frame is sent to the display.
+ * @details    The first call after the submenu is made current is the app's first frame; it
+ *           samples the tick and the free heap once.  This runs with the GUI locked, so it can't
+ *           unregister itself; it asks the view dispatcher to do it instead.
+ * @param      data         The frame buffer, unused.
+ * @param      size         The size of the frame buffer, unused.
+ * @param      orientation  The canvas orientation, unused.
+ * @param      context      The context - T5577WriterApp object.
+*/
+static void t5577_writer_startup_frame_callback(
+    uint8_t* data,
+    size_t size,
+    CanvasOrientation orientation,
+    void* context) {
+    UNUSED(data);
+    UNUSED(size);
+    UNUSED(orientation);
+    T5577WriterApp* app = (T5577WriterApp*)context;
+    T5577WriterStartup* startup = &app->startup;
+    if(!startup->armed || startup->first_frame_tick) return;
+    startup->first_frame_free_heap = memmgr_get_free_heap();
+    startup->first_frame_tick = furi_get_tick();
+    view_dispatcher_send_custom_event(app->view_dispatcher, T5577WriterEventIdFirstFrame);
+}
+
+/**
+ * @brief      Callback for custom events no view handled.
+ * @details    Unhooks the framebuffer callback once the first frame was sampled and logs the
+ *           startup cost.  Heap is the free heap at launch minus the free heap at the first frame.
+ * @param      context  The context - T5577WriterApp object.
+ * @param      event    The event id - T5577WriterEventId value.
+ * @return     true if the event was handled.
+*/
+static bool t5577_writer_custom_event_callback(void* context, uint32_t event) {
+    T5577WriterApp* app = (T5577WriterApp*)context;
+    T5577WriterStartup* startup = &app->startup;
+    if(event != T5577WriterEventIdFirstFrame) return false;
+    if(startup->hooked) {
+        gui_remove_framebuffer_callback(app->gui, t5577_writer_startup_frame_callback, app);
+        startup->hooked = false;
+    }
+    size_t free_heap = startup->first_frame_free_heap;
+    FURI_LOG_I(
+        TAG,
+        "First frame after %lu ms, heap %zu bytes at first frame",
+        startup->first_frame_tick - startup->start_tick,
+        startup->start_free_heap > free_heap ? startup->start_free_heap - free_heap : 0);
+    return true;
+}
+
 /**
  * @brief      Allocate the t5577_writer application.
- * @details    This function allocates the t5577_writer application resources.
+ * @details    This function allocates the t5577_writer application resources.  Only the submenu and
+ *           the write view (which owns the model) are created here, everything else is created by
+ *           t5577_writer_view_prepare the first time it is shown.
  * @return     T5577WriterApp object.
 */
 static T5577WriterApp* t5577_writer_app_alloc() {
+    uint32_t start_tick = furi_get_tick();
+    size_t start_free_heap = memmgr_get_free_heap();
     T5577WriterApp* app = (T5577WriterApp*)malloc(sizeof(T5577WriterApp));
+    memset(app, 0, sizeof(T5577WriterApp));
+    app->startup.start_tick = start_tick;
+    app->startup.start_free_heap = start_free_heap;
 
-    Gui* gui = furi_record_open(RECORD_GUI);
-
+    app->gui = furi_record_open(RECORD_GUI);
     app->view_dispatcher = view_dispatcher_alloc();
     app->dialogs = furi_record_open(RECORD_DIALOGS);
     app->file_path = furi_string_alloc();
     view_dispatcher_enable_queue(app->view_dispatcher);
-    view_dispatcher_attach_to_gui(app->view_dispatcher, gui, ViewDispatcherTypeFullscreen);
+    view_dispatcher_attach_to_gui(app->view_dispatcher, app->gui, ViewDispatcherTypeFullscreen);
     view_dispatcher_set_event_callback_context(app->view_dispatcher, app);
+    view_dispatcher_set_custom_event_callback(
+        app->view_dispatcher, t5577_writer_custom_event_callback);
+    gui_add_framebuffer_callback(app->gui, t5577_writer_startup_frame_callback, app);
+    app->startup.hooked = true;
     app->submenu = submenu_alloc();
     submenu_add_item(
         app->submenu, "Write", T5577WriterSubmenuIndexWrite, t5577_writer_submenu_callback, app);
@@ -653,25 +2363,24 @@ static T5577WriterApp* t5577_writer_app_alloc() {
         app->submenu, "Save", T5577WriterSubmenuIndexSave, t5577_writer_submenu_callback, app);
     submenu_add_item(
         app->submenu, "Load", T5577WriterSubmenuIndexLoad, t5577_writer_submenu_callback, app);
+    submenu_add_item(
+        app->submenu,
+        "Clear Password",
+        T5577WriterSubmenuIndexRecover,
+        t5577_writer_submenu_callback,
+        app);
+    submenu_add_item(
+        app->submenu, "Capture", T5577WriterSubmenuIndexCapture, t5577_writer_submenu_callback, app);
     submenu_add_item(
         app->submenu, "About", T5577WriterSubmenuIndexAbout, t5577_writer_submenu_callback, app);
     view_set_previous_callback(
         submenu_get_view(app->submenu), t5577_writer_navigation_exit_callback);
     view_dispatcher_add_view(
         app->view_dispatcher, T5577WriterViewSubmenu, submenu_get_view(app->submenu));
+    app->startup.armed = true; // Every frame from here on shows the submenu
     view_dispatcher_switch_to_view(app->view_dispatcher, T5577WriterViewSubmenu);
 
-    app->text_input = text_input_alloc();
-    view_dispatcher_add_view(
-        app->view_dispatcher, T5577WriterViewTextInput, text_input_get_view(app->text_input));
-
-    app->view_load = view_alloc();
-    view_set_previous_callback(app->view_load, t5577_writer_navigation_submenu_callback);
-    view_set_enter_callback(app->view_load, t5577_writer_view_load_callback);
-    view_set_context(app->view_load, app);
-    view_dispatcher_add_view(app->view_dispatcher, T5577WriterViewLoad, app->view_load);
-
-    app->temp_buffer_size = 32;
+    app->temp_buffer_size = T5577_WRITER_TAG_NAME_SIZE;
     app->temp_buffer = (char*)malloc(app->temp_buffer_size);
 
     app->view_write = view_alloc();
@@ -693,75 +2402,88 @@ static T5577WriterApp* t5577_writer_app_alloc() {
     initialize_model(model);
     initialize_rf_clock_choices(rf_clock_choices);
     initialize_mod_names(modulation_names);
-
-    app->view_save = view_alloc();
-    view_set_previous_callback(app->view_save, t5577_writer_navigation_submenu_callback);
-    view_set_enter_callback(app->view_save, t5577_writer_view_save_callback);
-    view_set_context(app->view_save, app);
-    view_dispatcher_add_view(app->view_dispatcher, T5577WriterViewSave, app->view_save);
+    t5577_writer_session_load(app);
 
     app->bytes_count = 4;
     memset(app->bytes_buffer, 0, sizeof(app->bytes_buffer));
 
-    app->byte_input = byte_input_alloc();
-    view_dispatcher_add_view(
-        app->view_dispatcher, T5577WriterViewByteInput, byte_input_get_view(app->byte_input));
-    
-    app->variable_item_list_config = variable_item_list_alloc();
-    app->view_config_e = view_alloc();
-    view_set_previous_callback(app->view_config_e, t5577_writer_navigation_submenu_callback);
-    view_set_enter_callback(app->view_config_e, t5577_writer_config_enter_callback);
-    view_set_context(app->view_config_e, app);
-    view_dispatcher_add_view(app->view_dispatcher, T5577WriterViewConfigure_e, app->view_config_e);
-
-    View* view_buffer = view_alloc();
-    view_dispatcher_add_view(app->view_dispatcher, T5577WriterViewConfigure_i, view_buffer);
-
-    app->widget_about = widget_alloc();
-    widget_add_text_scroll_element(
-        app->widget_about,
-        0,
-        0,
-        128,
-        64,
-        "T5577 Raw Writer v1.2\n\nAuthor: @Torron\n\nGithub: https://github.com/zinongli/T5577_Raw_Writer");
-    view_set_previous_callback(
-        widget_get_view(app->widget_about), t5577_writer_navigation_submenu_callback);
-    view_dispatcher_add_view(
-        app->view_dispatcher, T5577WriterViewAbout, widget_get_view(app->widget_about));
-
     app->notifications = furi_record_open(RECORD_NOTIFICATION);
 
+    app->rf_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    app->cli = furi_record_open(RECORD_CLI);
+    cli_add_command(
+        app->cli, T5577_WRITER_CLI_COMMAND, CliCommandFlagParallelSafe, t5577_writer_cli, app);
+
     return app;
 }
 
 /**
  * @brief      Free the t5577_writer application.
- * @details    This function frees the t5577_writer application resources.
+ * @details    This function frees the t5577_writer application resources.  Views that were never
+ *           shown were never allocated, so they are skipped.
  * @param      app  The t5577_writer application object.
 */
 static void t5577_writer_app_free(T5577WriterApp* app) {
-    
+    // A command that is already running still holds the RF hardware, wait for it to be done
+    cli_delete_command(app->cli, T5577_WRITER_CLI_COMMAND);
+    furi_record_close(RECORD_CLI);
+    furi_mutex_acquire(app->rf_mutex, FuriWaitForever);
+    furi_mutex_release(app->rf_mutex);
+    furi_mutex_free(app->rf_mutex);
+
+    t5577_writer_session_save(app);
+
     furi_record_close(RECORD_NOTIFICATION);
 
-    view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewTextInput);
-    text_input_free(app->text_input);
+    if(app->text_input) {
+        view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewTextInput);
+        text_input_free(app->text_input);
+    }
     free(app->temp_buffer);
-    view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewAbout);
-    widget_free(app->widget_about);
+    if(app->widget_about) {
+        view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewAbout);
+        widget_free(app->widget_about);
+    }
     view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewWrite);
+    T5577WriterModel* model = view_get_model(app->view_write);
+    furi_string_free(model->tag_name_str);
     view_free(app->view_write);
-    view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewLoad);
-    view_free(app->view_load);
-    view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewConfigure_i);
-    view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewConfigure_e);
-    view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewByteInput);
-    variable_item_list_free(app->variable_item_list_config);
-    view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewSave);
-    view_free(app->view_save);
+    if(app->view_load) {
+        view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewLoad);
+        view_free(app->view_load);
+    }
+    if(app->variable_item_list_config) {
+        view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewConfigure_i);
+        variable_item_list_free(app->variable_item_list_config);
+    }
+    if(app->view_config_e) {
+        view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewConfigure_e);
+        view_free(app->view_config_e);
+    }
+    if(app->byte_input) {
+        view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewByteInput);
+        byte_input_free(app->byte_input);
+    }
+    if(app->view_save) {
+        view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewSave);
+        view_free(app->view_save);
+    }
+    if(app->view_recover) {
+        view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewRecover);
+        view_free(app->view_recover);
+    }
+    if(app->view_capture) {
+        view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewCapture);
+        view_free(app->view_capture);
+    }
     view_dispatcher_remove_view(app->view_dispatcher, T5577WriterViewSubmenu);
     submenu_free(app->submenu);
     view_dispatcher_free(app->view_dispatcher);
+    furi_string_free(app->file_path);
+    furi_record_close(RECORD_DIALOGS);
+    if(app->startup.hooked) {
+        gui_remove_framebuffer_callback(app->gui, t5577_writer_startup_frame_callback, app);
+    }
     furi_record_close(RECORD_GUI);
 
     free(app);
@@ -0,0 +1,58 @@
+// Host stand-in for the firmware's dialogs/dialogs.h. Both dialogs block until the user answers;
+// on the host the answer is the next one the script queued.
+#pragma once
+
+#include <gui/gui.h>
+
+typedef struct DialogsApp DialogsApp;
+
+typedef struct {
+    const char* extension;
+    const char* base_path;
+    bool skip_assets;
+    bool hide_dot_files;
+    const Icon* icon;
+    bool hide_ext;
+} DialogsFileBrowserOptions;
+
+void dialog_file_browser_set_basic_options(
+    DialogsFileBrowserOptions* options,
+    const char* extension,
+    const Icon* icon);
+bool dialog_file_browser_show(
+    DialogsApp* context,
+    FuriString* result_path,
+    FuriString* path,
+    const DialogsFileBrowserOptions* options);
+
+typedef struct DialogMessage DialogMessage;
+
+typedef enum {
+    DialogMessageButtonBack,
+    DialogMessageButtonLeft,
+    DialogMessageButtonCenter,
+    DialogMessageButtonRight,
+} DialogMessageButton;
+
+DialogMessage* dialog_message_alloc(void);
+void dialog_message_free(DialogMessage* message);
+void dialog_message_set_header(
+    DialogMessage* message,
+    const char* text,
+    uint8_t x,
+    uint8_t y,
+    Align horizontal,
+    Align vertical);
+void dialog_message_set_text(
+    DialogMessage* message,
+    const char* text,
+    uint8_t x,
+    uint8_t y,
+    Align horizontal,
+    Align vertical);
+void dialog_message_set_buttons(
+    DialogMessage* message,
+    const char* left,
+    const char* center,
+    const char* right);
+DialogMessageButton dialog_message_show(DialogsApp* context, const DialogMessage* message);
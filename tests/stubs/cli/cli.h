@@ -0,0 +1,24 @@
+// Host stand-in for the firmware's cli/cli.h. The harness runs a command from a script line.
+#pragma once
+
+#include <furi.h>
+
+#define RECORD_CLI "cli"
+
+typedef struct Cli Cli;
+
+typedef enum {
+    CliCommandFlagDefault = 0,
+    CliCommandFlagParallelSafe = (1 << 0),
+    CliCommandFlagInsomniaSafe = (1 << 1),
+} CliCommandFlag;
+
+typedef void (*CliCallback)(Cli* cli, FuriString* args, void* context);
+
+void cli_add_command(
+    Cli* cli,
+    const char* name,
+    CliCommandFlag flags,
+    CliCallback callback,
+    void* context);
+void cli_delete_command(Cli* cli, const char* name);
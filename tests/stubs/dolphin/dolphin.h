@@ -0,0 +1,9 @@
+// Host stand-in for the firmware's dolphin/dolphin.h
+#pragma once
+
+typedef enum {
+    DolphinDeedRfidRead,
+    DolphinDeedRfidEmulate,
+} DolphinDeed;
+
+void dolphin_deed(DolphinDeed deed);
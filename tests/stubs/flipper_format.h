@@ -0,0 +1,51 @@
+// Host stand-in for the firmware's flipper_format/flipper_format.h: "Key: value" lines, read
+// forward from the current position like the firmware does.
+#pragma once
+
+#include <storage/storage.h>
+
+typedef struct FlipperFormat FlipperFormat;
+
+FlipperFormat* flipper_format_file_alloc(Storage* storage);
+void flipper_format_free(FlipperFormat* flipper_format);
+bool flipper_format_file_open_existing(FlipperFormat* flipper_format, const char* path);
+bool flipper_format_file_open_always(FlipperFormat* flipper_format, const char* path);
+bool flipper_format_rewind(FlipperFormat* flipper_format);
+bool flipper_format_write_header_cstr(
+    FlipperFormat* flipper_format,
+    const char* filetype,
+    const uint32_t version);
+bool flipper_format_write_string_cstr(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const char* data);
+bool flipper_format_write_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint32_t* data,
+    const uint16_t data_size);
+bool flipper_format_read_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint32_t* data,
+    const uint16_t data_size);
+bool flipper_format_write_bool(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const bool* data,
+    const uint16_t data_size);
+bool flipper_format_read_bool(
+    FlipperFormat* flipper_format,
+    const char* key,
+    bool* data,
+    const uint16_t data_size);
+bool flipper_format_write_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint8_t* data,
+    const uint16_t data_size);
+bool flipper_format_read_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint8_t* data,
+    const uint16_t data_size);
@@ -0,0 +1,112 @@
+// Host stand-in for the firmware's furi.h, for t5577_harness: the parts of the Furi API the app
+// uses. Time is virtual and only moves when the harness or a delay moves it, see t5577_harness.h.
+#pragma once
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UNUSED(x)   (void)(x)
+#define COUNT_OF(x) (sizeof(x) / sizeof(x[0]))
+#define MIN(a, b)   ((a) < (b) ? (a) : (b))
+#define MAX(a, b)   ((a) > (b) ? (a) : (b))
+
+#define STORAGE_APP_DATA_PATH_PREFIX "/data"
+
+#define RECORD_GUI          "gui"
+#define RECORD_STORAGE      "storage"
+#define RECORD_DIALOGS      "dialogs"
+#define RECORD_NOTIFICATION "notification"
+
+_Noreturn void furi_crash_at(const char* file, int line, const char* expression);
+#define furi_check(x)  ((x) ? (void)0 : furi_crash_at(__FILE__, __LINE__, #x))
+#define furi_assert(x) furi_check(x)
+
+// Nothing runs concurrently with the app on the host
+#define FURI_CRITICAL_ENTER()
+#define FURI_CRITICAL_EXIT()
+
+typedef enum {
+    FuriLogLevelError = 1,
+    FuriLogLevelWarn,
+    FuriLogLevelInfo,
+    FuriLogLevelDebug,
+} FuriLogLevel;
+
+void furi_log_print_format(FuriLogLevel level, const char* tag, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+#define FURI_LOG_E(tag, format, ...) \
+    furi_log_print_format(FuriLogLevelError, tag, format, ##__VA_ARGS__)
+#define FURI_LOG_W(tag, format, ...) \
+    furi_log_print_format(FuriLogLevelWarn, tag, format, ##__VA_ARGS__)
+#define FURI_LOG_I(tag, format, ...) \
+    furi_log_print_format(FuriLogLevelInfo, tag, format, ##__VA_ARGS__)
+#define FURI_LOG_D(tag, format, ...) \
+    furi_log_print_format(FuriLogLevelDebug, tag, format, ##__VA_ARGS__)
+
+typedef enum {
+    FuriStatusOk = 0,
+    FuriStatusError = -1,
+    FuriStatusErrorTimeout = -2,
+} FuriStatus;
+
+#define FuriWaitForever 0xFFFFFFFFU
+
+typedef struct FuriString FuriString;
+FuriString* furi_string_alloc(void);
+void furi_string_free(FuriString* string);
+void furi_string_reset(FuriString* string);
+void furi_string_set_str(FuriString* string, const char* text);
+void furi_string_set_string(FuriString* string, const FuriString* source);
+#define furi_string_set(string, source)                                       \
+    _Generic((source), FuriString*: furi_string_set_string, const FuriString*: \
+                 furi_string_set_string, default: furi_string_set_str)(string, source)
+void furi_string_cat_str(FuriString* string, const char* text);
+void furi_string_cat_string(FuriString* string, const FuriString* source);
+#define furi_string_cat(string, source)                                       \
+    _Generic((source), FuriString*: furi_string_cat_string, const FuriString*: \
+                 furi_string_cat_string, default: furi_string_cat_str)(string, source)
+int furi_string_printf(FuriString* string, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+int furi_string_cat_printf(FuriString* string, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+const char* furi_string_get_cstr(const FuriString* string);
+size_t furi_string_size(const FuriString* string);
+bool furi_string_empty(const FuriString* string);
+void furi_string_trim(FuriString* string);
+
+typedef enum {
+    FuriTimerTypeOnce,
+    FuriTimerTypePeriodic,
+} FuriTimerType;
+typedef void (*FuriTimerCallback)(void* context);
+typedef struct FuriTimer FuriTimer;
+FuriTimer* furi_timer_alloc(FuriTimerCallback callback, FuriTimerType type, void* context);
+void furi_timer_free(FuriTimer* timer);
+FuriStatus furi_timer_start(FuriTimer* timer, uint32_t ticks);
+FuriStatus furi_timer_stop(FuriTimer* timer);
+
+uint32_t furi_get_tick(void); // One tick per millisecond, like the firmware
+uint32_t furi_ms_to_ticks(uint32_t milliseconds);
+void furi_delay_ms(uint32_t milliseconds);
+void furi_delay_us(uint32_t microseconds);
+
+typedef enum {
+    FuriMutexTypeNormal,
+    FuriMutexTypeRecursive,
+} FuriMutexType;
+typedef struct FuriMutex FuriMutex;
+FuriMutex* furi_mutex_alloc(FuriMutexType type);
+void furi_mutex_free(FuriMutex* mutex);
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout);
+FuriStatus furi_mutex_release(FuriMutex* mutex);
+
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+size_t memmgr_get_free_heap(void);
+size_t memmgr_get_minimum_free_heap(void);
@@ -0,0 +1,12 @@
+// Host stand-in for the firmware's furi_hal.h: the RFID timer calls the write path makes. On the
+// host they drive the simulated tag in t5577_fake_tag.c.
+#pragma once
+
+#include <furi.h>
+
+void furi_hal_rfid_tim_read_start(float frequency, float duty_cycle);
+void furi_hal_rfid_tim_read_stop(void);
+void furi_hal_rfid_tim_read_pause(void);
+void furi_hal_rfid_tim_read_continue(void);
+void furi_hal_rfid_pin_pull_release(void);
+void furi_hal_rfid_pins_reset(void);
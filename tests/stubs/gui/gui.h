@@ -0,0 +1,56 @@
+// Host stand-in for the firmware's gui/gui.h and gui/canvas.h. The canvas keeps the strings that
+// were drawn, so a script can check what is on screen.
+#pragma once
+
+#include <furi.h>
+
+typedef struct Gui Gui;
+typedef struct Canvas Canvas;
+
+typedef struct {
+    const char* name;
+    uint8_t width;
+    uint8_t height;
+} Icon;
+
+typedef enum {
+    AlignLeft,
+    AlignRight,
+    AlignTop,
+    AlignBottom,
+    AlignCenter,
+} Align;
+
+typedef enum {
+    FontPrimary,
+    FontSecondary,
+    FontKeyboard,
+    FontBigNumbers,
+} Font;
+
+typedef enum {
+    CanvasOrientationHorizontal,
+    CanvasOrientationHorizontalFlip,
+    CanvasOrientationVertical,
+    CanvasOrientationVerticalFlip,
+} CanvasOrientation;
+
+void canvas_set_bitmap_mode(Canvas* canvas, bool alpha);
+void canvas_set_font(Canvas* canvas, Font font);
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon);
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* text);
+void canvas_draw_str_aligned(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    Align horizontal,
+    Align vertical,
+    const char* text);
+
+typedef void (*GuiCanvasCommitCallback)(
+    uint8_t* data,
+    size_t size,
+    CanvasOrientation orientation,
+    void* context);
+void gui_add_framebuffer_callback(Gui* gui, GuiCanvasCommitCallback callback, void* context);
+void gui_remove_framebuffer_callback(Gui* gui, GuiCanvasCommitCallback callback, void* context);
@@ -0,0 +1,18 @@
+// Host stand-in for the firmware's gui/modules/submenu.h
+#pragma once
+
+#include <gui/view.h>
+
+typedef struct Submenu Submenu;
+typedef void (*SubmenuItemCallback)(void* context, uint32_t index);
+
+Submenu* submenu_alloc(void);
+void submenu_free(Submenu* submenu);
+View* submenu_get_view(Submenu* submenu);
+void submenu_add_item(
+    Submenu* submenu,
+    const char* label,
+    uint32_t index,
+    SubmenuItemCallback callback,
+    void* callback_context);
+void submenu_reset(Submenu* submenu);
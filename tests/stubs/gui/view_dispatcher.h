@@ -0,0 +1,34 @@
+// Host stand-in for the firmware's gui/view_dispatcher.h. view_dispatcher_run plays the script
+// instead of waiting for the user, see t5577_harness.h.
+#pragma once
+
+#include <gui/view.h>
+
+typedef struct ViewDispatcher ViewDispatcher;
+
+typedef enum {
+    ViewDispatcherTypeDesktop,
+    ViewDispatcherTypeWindow,
+    ViewDispatcherTypeFullscreen,
+} ViewDispatcherType;
+
+typedef bool (*ViewDispatcherCustomEventCallback)(void* context, uint32_t event);
+typedef bool (*ViewDispatcherNavigationEventCallback)(void* context);
+
+ViewDispatcher* view_dispatcher_alloc(void);
+void view_dispatcher_free(ViewDispatcher* view_dispatcher);
+void view_dispatcher_enable_queue(ViewDispatcher* view_dispatcher);
+void view_dispatcher_attach_to_gui(
+    ViewDispatcher* view_dispatcher,
+    Gui* gui,
+    ViewDispatcherType type);
+void view_dispatcher_set_event_callback_context(ViewDispatcher* view_dispatcher, void* context);
+void view_dispatcher_set_custom_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherCustomEventCallback callback);
+void view_dispatcher_add_view(ViewDispatcher* view_dispatcher, uint32_t view_id, View* view);
+void view_dispatcher_remove_view(ViewDispatcher* view_dispatcher, uint32_t view_id);
+void view_dispatcher_switch_to_view(ViewDispatcher* view_dispatcher, uint32_t view_id);
+void view_dispatcher_send_custom_event(ViewDispatcher* view_dispatcher, uint32_t event);
+void view_dispatcher_run(ViewDispatcher* view_dispatcher);
+void view_dispatcher_stop(ViewDispatcher* view_dispatcher);
@@ -0,0 +1,27 @@
+// Host stand-in for the firmware's input/input.h
+#pragma once
+
+#include <furi.h>
+
+typedef enum {
+    InputKeyUp,
+    InputKeyDown,
+    InputKeyRight,
+    InputKeyLeft,
+    InputKeyOk,
+    InputKeyBack,
+    InputKeyMAX,
+} InputKey;
+
+typedef enum {
+    InputTypePress,
+    InputTypeRelease,
+    InputTypeShort,
+    InputTypeLong,
+    InputTypeRepeat,
+} InputType;
+
+typedef struct {
+    InputKey key;
+    InputType type;
+} InputEvent;
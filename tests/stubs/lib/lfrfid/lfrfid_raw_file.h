@@ -0,0 +1,16 @@
+// Host stand-in for the firmware's lib/lfrfid/lfrfid_raw_file.h, reading only
+#pragma once
+
+#include <storage/storage.h>
+
+typedef struct LFRFIDRawFile LFRFIDRawFile;
+
+LFRFIDRawFile* lfrfid_raw_file_alloc(Storage* storage);
+void lfrfid_raw_file_free(LFRFIDRawFile* file);
+bool lfrfid_raw_file_open_read(LFRFIDRawFile* file, const char* file_path);
+bool lfrfid_raw_file_read_header(LFRFIDRawFile* file, float* frequency, float* duty_cycle);
+bool lfrfid_raw_file_read_pair(
+    LFRFIDRawFile* file,
+    uint32_t* duration,
+    uint32_t* pulse,
+    bool* pass_end);
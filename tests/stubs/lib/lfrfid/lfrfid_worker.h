@@ -0,0 +1,33 @@
+// Host stand-in for the firmware's lib/lfrfid/lfrfid_worker.h: the raw read only. It records
+// the simulated tag's reply at once, see t5577_fake_tag.c.
+#pragma once
+
+#include <furi.h>
+
+typedef struct ProtocolDict ProtocolDict;
+typedef struct LFRFIDWorker LFRFIDWorker;
+
+typedef enum {
+    LFRFIDWorkerReadTypeAuto,
+    LFRFIDWorkerReadTypeASKOnly,
+    LFRFIDWorkerReadTypePSKOnly,
+} LFRFIDWorkerReadType;
+
+typedef enum {
+    LFRFIDWorkerReadRawFileError,
+    LFRFIDWorkerReadRawOverrun,
+} LFRFIDWorkerReadRawResult;
+
+typedef void (*LFRFIDWorkerReadRawCallback)(LFRFIDWorkerReadRawResult result, void* context);
+
+LFRFIDWorker* lfrfid_worker_alloc(ProtocolDict* dict);
+void lfrfid_worker_free(LFRFIDWorker* worker);
+void lfrfid_worker_start_thread(LFRFIDWorker* worker);
+void lfrfid_worker_stop_thread(LFRFIDWorker* worker);
+void lfrfid_worker_stop(LFRFIDWorker* worker);
+void lfrfid_worker_read_raw_start(
+    LFRFIDWorker* worker,
+    const char* filename,
+    LFRFIDWorkerReadType type,
+    LFRFIDWorkerReadRawCallback callback,
+    void* context);
@@ -0,0 +1,16 @@
+// Host stand-in for the firmware's lib/lfrfid/protocols/lfrfid_protocols.h
+#pragma once
+
+#include <lib/lfrfid/lfrfid_worker.h>
+
+typedef struct ProtocolBase ProtocolBase;
+
+typedef enum {
+    LFRFIDProtocolEM4100,
+    LFRFIDProtocolMax,
+} LFRFIDProtocol;
+
+extern const ProtocolBase* lfrfid_protocols[];
+
+ProtocolDict* protocol_dict_alloc(const ProtocolBase** protocols, size_t protocol_count);
+void protocol_dict_free(ProtocolDict* dict);
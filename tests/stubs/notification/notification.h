@@ -0,0 +1,10 @@
+// Host stand-in for the firmware's notification/notification.h. A sequence is only a name here.
+#pragma once
+
+typedef struct NotificationApp NotificationApp;
+
+typedef struct {
+    const char* name;
+} NotificationSequence;
+
+void notification_message(NotificationApp* app, const NotificationSequence* sequence);
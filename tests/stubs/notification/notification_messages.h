@@ -0,0 +1,9 @@
+#pragma once
+
+#include <notification/notification.h>
+
+extern const NotificationSequence sequence_success;
+extern const NotificationSequence sequence_error;
+extern const NotificationSequence sequence_blink_stop;
+extern const NotificationSequence sequence_blink_start_cyan;
+extern const NotificationSequence sequence_blink_start_magenta;
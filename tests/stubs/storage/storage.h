@@ -0,0 +1,33 @@
+// Host stand-in for the firmware's storage/storage.h. Paths under /data are kept in the
+// harness's data directory on the host, see t5577_harness.h.
+#pragma once
+
+#include <furi.h>
+
+typedef struct Storage Storage;
+typedef struct File File;
+
+typedef enum {
+    FSAM_READ = (1 << 0),
+    FSAM_WRITE = (1 << 1),
+    FSAM_READ_WRITE = FSAM_READ | FSAM_WRITE,
+} FS_AccessMode;
+
+typedef enum {
+    FSOM_OPEN_EXISTING = 1,
+    FSOM_OPEN_ALWAYS = 2,
+    FSOM_OPEN_APPEND = 4,
+    FSOM_CREATE_NEW = 8,
+    FSOM_CREATE_ALWAYS = 16,
+} FS_OpenMode;
+
+File* storage_file_alloc(Storage* storage);
+void storage_file_free(File* file);
+bool storage_file_open(File* file, const char* path, FS_AccessMode access, FS_OpenMode mode);
+bool storage_file_close(File* file);
+size_t storage_file_read(File* file, void* buffer, size_t size);
+size_t storage_file_write(File* file, const void* buffer, size_t size);
+bool storage_file_eof(File* file);
+bool storage_file_exists(Storage* storage, const char* path);
+bool storage_simply_mkdir(Storage* storage, const char* path);
+bool storage_simply_remove(Storage* storage, const char* path);
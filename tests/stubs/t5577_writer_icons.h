@@ -0,0 +1,8 @@
+// Host stand-in for the header fbt generates from assets/
+#pragma once
+
+#include <gui/gui.h>
+
+extern const Icon I_icon;
+extern const Icon I_NFC_manual_60x50;
+extern const Icon I_DolphinSuccess_91x55;
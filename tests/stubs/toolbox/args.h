@@ -0,0 +1,7 @@
+// Host stand-in for the firmware's toolbox/args.h
+#pragma once
+
+#include <furi.h>
+
+// Moves the first word of args to word, and trims args. Returns false if args was empty.
+bool args_read_string_and_trim(FuriString* args, FuriString* word);
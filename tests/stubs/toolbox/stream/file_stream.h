@@ -0,0 +1,9 @@
+// Host stand-in for the firmware's toolbox/stream/file_stream.h
+#pragma once
+
+#include <storage/storage.h>
+#include <toolbox/stream/stream.h>
+
+Stream* file_stream_alloc(Storage* storage);
+bool file_stream_open(Stream* stream, const char* path, FS_AccessMode access, FS_OpenMode mode);
+bool file_stream_close(Stream* stream);
@@ -0,0 +1,21 @@
+// Host stand-in for the firmware's toolbox/stream/stream.h
+#pragma once
+
+#include <furi.h>
+
+typedef struct Stream Stream;
+
+typedef enum {
+    StreamOffsetFromCurrent,
+    StreamOffsetFromStart,
+    StreamOffsetFromEnd,
+} StreamOffset;
+
+void stream_free(Stream* stream);
+size_t stream_read(Stream* stream, uint8_t* data, size_t size);
+size_t stream_write(Stream* stream, const uint8_t* data, size_t size);
+bool stream_read_line(Stream* stream, FuriString* line);
+bool stream_rewind(Stream* stream);
+bool stream_seek(Stream* stream, int32_t offset, StreamOffset offset_type);
+size_t stream_tell(Stream* stream);
+size_t stream_size(Stream* stream);
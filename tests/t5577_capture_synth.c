@@ -0,0 +1,149 @@
+#include "t5577_capture_synth.h"
+
+#include <lib/lfrfid/tools/t5577.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FSK_MID     8
+#define PSK_CARRIER 2
+
+static uint32_t capture_random(Capture* capture) {
+    // xorshift32, so every run sees the same capture
+    capture->rng ^= capture->rng << 13;
+    capture->rng ^= capture->rng >> 17;
+    capture->rng ^= capture->rng << 5;
+    return capture->rng;
+}
+
+static uint32_t capture_us(Capture* capture, uint32_t cycles) {
+    int32_t us = (int32_t)(cycles * capture->cycle_us + 0.5f);
+    if(capture->jitter_us) {
+        us += (int32_t)(capture_random(capture) % (2 * capture->jitter_us + 1)) -
+              (int32_t)capture->jitter_us;
+    }
+    return us > 1 ? (uint32_t)us : 1;
+}
+
+static void capture_push(Capture* capture) {
+    if(capture->count == capture->capacity) {
+        capture->capacity = capture->capacity ? capture->capacity * 2 : 4096;
+        capture->durations = realloc(capture->durations, capture->capacity * sizeof(uint32_t));
+        capture->pulses = realloc(capture->pulses, capture->capacity * sizeof(uint32_t));
+    }
+    uint32_t pulse = capture_us(capture, capture->high);
+    uint32_t duration = pulse + capture_us(capture, capture->low);
+    capture->durations[capture->count] = duration;
+    capture->pulses[capture->count] = pulse;
+    capture->count++;
+}
+
+// Emit one carrier cycle of the envelope. Pairs are cut at rising edges, like the firmware's timer.
+static void capture_cycle(Capture* capture, uint8_t level) {
+    if(level && !capture->level) {
+        if(capture->started) capture_push(capture);
+        capture->started = true;
+        capture->high = 0;
+        capture->low = 0;
+    }
+    capture->level = level;
+    if(level) {
+        capture->high++;
+    } else {
+        capture->low++;
+    }
+    capture->cycle++;
+}
+
+static void capture_level(Capture* capture, uint8_t level, uint32_t cycles) {
+    for(uint32_t i = 0; i < cycles; i++) {
+        capture_cycle(capture, level);
+    }
+}
+
+// A square sub-carrier that restarts at the start of the bit and is cut off at its end
+static void capture_subcarrier(Capture* capture, uint32_t period, uint32_t cycles) {
+    for(uint32_t i = 0; i < cycles; i++) {
+        capture_cycle(capture, (i % period) < period / 2);
+    }
+}
+
+void capture_generate(Capture* capture, uint32_t modulation, uint32_t clock) {
+    uint32_t bits = CAPTURE_CYCLES / clock;
+    uint8_t level = 0;
+    uint8_t phase = 0;
+    bool previous = false;
+    for(uint32_t n = 0; n < bits; n++) {
+        bool bit = capture_random(capture) & 1;
+        switch(modulation) {
+        case LFRFID_T5577_MODULATION_DIRECT:
+            capture_level(capture, bit, clock);
+            break;
+        case LFRFID_T5577_MODULATION_MANCHESTER:
+            capture_level(capture, bit, clock / 2);
+            capture_level(capture, !bit, clock - clock / 2);
+            break;
+        case LFRFID_T5577_MODULATION_BIPHASE:
+        case LFRFID_T5577_MODULATION_DIPHASE:
+            // A transition at every bit start, and one mid-bit for 0 (biphase) or 1 (diphase)
+            level = !level;
+            capture_level(capture, level, clock / 2);
+            if(bit == (modulation == LFRFID_T5577_MODULATION_DIPHASE)) level = !level;
+            capture_level(capture, level, clock - clock / 2);
+            break;
+        case LFRFID_T5577_MODULATION_FSK1:
+            capture_subcarrier(capture, bit ? 5 : FSK_MID, clock);
+            break;
+        case LFRFID_T5577_MODULATION_FSK1a:
+            capture_subcarrier(capture, bit ? FSK_MID : 5, clock);
+            break;
+        case LFRFID_T5577_MODULATION_FSK2:
+            capture_subcarrier(capture, bit ? 10 : FSK_MID, clock);
+            break;
+        case LFRFID_T5577_MODULATION_FSK2a:
+            capture_subcarrier(capture, bit ? FSK_MID : 10, clock);
+            break;
+        default:
+            // PSK1 shifts when the data changes, PSK2 after every 1, PSK3 on a rising data edge
+            if((modulation == LFRFID_T5577_MODULATION_PSK1 && bit != previous) ||
+               (modulation == LFRFID_T5577_MODULATION_PSK2 && previous) ||
+               (modulation == LFRFID_T5577_MODULATION_PSK3 && bit && !previous)) {
+                phase = !phase;
+            }
+            for(uint32_t i = 0; i < clock; i++) {
+                capture_cycle(capture, ((capture->cycle + phase) % PSK_CARRIER) == 0);
+            }
+            break;
+        }
+        previous = bit;
+    }
+}
+
+void capture_init(Capture* capture, float frequency, uint32_t jitter_us, uint32_t seed) {
+    memset(capture, 0, sizeof(Capture));
+    capture->cycle_us = 1000000.0f / frequency;
+    capture->jitter_us = jitter_us;
+    capture->rng = seed;
+}
+
+void capture_free(Capture* capture) {
+    free(capture->durations);
+    free(capture->pulses);
+}
+
+// The envelope can't tell these apart, so the detector picks the first of each group on purpose
+uint32_t modulation_group(uint32_t modulation) {
+    switch(modulation) {
+    case LFRFID_T5577_MODULATION_FSK1a:
+        return LFRFID_T5577_MODULATION_FSK1;
+    case LFRFID_T5577_MODULATION_FSK2a:
+        return LFRFID_T5577_MODULATION_FSK2;
+    case LFRFID_T5577_MODULATION_PSK2:
+    case LFRFID_T5577_MODULATION_PSK3:
+        return LFRFID_T5577_MODULATION_PSK1;
+    case LFRFID_T5577_MODULATION_BIPHASE:
+    case LFRFID_T5577_MODULATION_DIPHASE:
+        return LFRFID_T5577_MODULATION_MANCHESTER;
+    default:
+        return modulation;
+    }
+}
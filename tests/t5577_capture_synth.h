@@ -0,0 +1,36 @@
+// Synthetic raw captures for the host tests: the envelope the capture screen would record from
+// a tag with a given modulation and RF clock, as the period and high time pairs of a .raw file.
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define CAPTURE_CYCLES 250000 // 2 seconds of capture at 125 kHz, the same as the capture screen
+
+typedef struct {
+    uint32_t* durations;
+    uint32_t* pulses;
+    size_t count;
+    size_t capacity;
+
+    float cycle_us; // One carrier period at the capture's frequency
+    uint32_t jitter_us; // Every edge moves by up to this much
+    uint32_t rng;
+
+    uint8_t level;
+    bool started; // A rising edge was seen, so the current period is complete
+    uint32_t high; // Cycles of the current period
+    uint32_t low;
+    uint32_t cycle; // Cycles emitted so far
+} Capture;
+
+void capture_init(Capture* capture, float frequency, uint32_t jitter_us, uint32_t seed);
+
+// CAPTURE_CYCLES of random data sent with this modulation (block 0 bits) and RF clock
+void capture_generate(Capture* capture, uint32_t modulation, uint32_t clock);
+
+void capture_free(Capture* capture);
+
+// The envelope can't tell these apart, so the detector picks the first of each group on purpose
+uint32_t modulation_group(uint32_t modulation);
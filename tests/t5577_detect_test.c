@@ -0,0 +1,106 @@
+// Host checks for t5577_detect: every modulation and RF clock is synthesized as the envelope the
+// raw capture would record, fed to the detector, and the match and the time it took are reported.
+
+#include "t5577_capture_synth.h"
+#include "t5577_detect.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int failures = 0;
+static double total_ms = 0;
+static double max_ms = 0;
+static size_t total_periods = 0;
+
+static void check_detect(uint8_t m, uint8_t c, float frequency, uint32_t jitter_us) {
+    Capture capture;
+    capture_init(&capture, frequency, jitter_us, 0x1234567u + m * 31 + c);
+    capture_generate(&capture, all_mods[m].mod_page_zero, all_rf_clocks[c].rf_clock_num);
+
+    T5577Detect* detect = t5577_detect_alloc();
+    double start = now_ms();
+    bool supported = t5577_detect_reset(detect, frequency);
+    for(size_t i = 0; i < capture.count; i++) {
+        t5577_detect_feed(detect, capture.durations[i], capture.pulses[i]);
+    }
+    T5577DetectResult result;
+    bool found = t5577_detect_result(detect, &result);
+    double elapsed = now_ms() - start;
+    t5577_detect_free(detect);
+
+    bool pass = supported && found &&
+                modulation_group(all_mods[result.modulation_index].mod_page_zero) ==
+                    modulation_group(all_mods[m].mod_page_zero) &&
+                result.rf_clock_index == c;
+    printf(
+        "%-4s %-8s RF/%-3u %6.0f Hz +-%u us -> %-8s RF/%-3u %3u%% %7zu periods %7.2f ms\n",
+        pass ? "ok" : "FAIL",
+        all_mods[m].modulation_name,
+        all_rf_clocks[c].rf_clock_num,
+        frequency,
+        jitter_us,
+        found ? all_mods[result.modulation_index].modulation_name : "-",
+        found ? all_rf_clocks[result.rf_clock_index].rf_clock_num : 0,
+        found ? result.confidence : 0,
+        capture.count,
+        elapsed);
+    if(!pass) failures++;
+    total_ms += elapsed;
+    if(elapsed > max_ms) max_ms = elapsed;
+    total_periods += capture.count;
+    capture_free(&capture);
+}
+
+// A PSK capture (62.5 kHz) must be refused, not scored as if it were 125 kHz
+static void check_rejected(float frequency) {
+    Capture capture;
+    capture_init(&capture, frequency, 0, 1);
+    capture_generate(&capture, LFRFID_T5577_MODULATION_MANCHESTER, 64);
+    T5577Detect* detect = t5577_detect_alloc();
+    bool supported = t5577_detect_reset(detect, frequency);
+    for(size_t i = 0; i < capture.count; i++) {
+        t5577_detect_feed(detect, capture.durations[i], capture.pulses[i]);
+    }
+    T5577DetectResult result;
+    bool pass = !supported && !t5577_detect_result(detect, &result);
+    printf("%-4s %6.0f Hz capture rejected\n", pass ? "ok" : "FAIL", frequency);
+    if(!pass) failures++;
+    t5577_detect_free(detect);
+    capture_free(&capture);
+}
+
+int main(void) {
+    for(uint8_t m = 0; m < MODULATION_NUM; m++) {
+        for(uint8_t c = 0; c < CLOCK_NUM; c++) {
+            // A bit shorter than one RF/10 period can't carry FSK2
+            uint32_t fsk2 = modulation_group(all_mods[m].mod_page_zero) ==
+                            LFRFID_T5577_MODULATION_FSK2;
+            if(fsk2 && all_rf_clocks[c].rf_clock_num < 10) continue;
+            check_detect(m, c, T5577_DETECT_FREQUENCY, 0);
+            check_detect(m, c, T5577_DETECT_FREQUENCY, 1);
+        }
+    }
+    // The header frequency is used for the cycle length, not a fixed 8 us
+    for(uint8_t c = 0; c < CLOCK_NUM; c++) {
+        check_detect(0, c, 124000.0f, 0);
+        check_detect(8, c, 126000.0f, 0);
+    }
+    check_rejected(62500.0f);
+    check_rejected(100000.0f);
+
+    printf(
+        "\n%zu periods scored in %.1f ms, %.2f ms per capture at most\n",
+        total_periods,
+        total_ms,
+        max_ms);
+    if(failures) printf("%d failed\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
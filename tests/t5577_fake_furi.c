@@ -0,0 +1,547 @@
+// The Furi core on the host, for t5577_harness: strings, timers on the virtual clock, mutexes,
+// records and the log, plus the small services the app opens: the CLI, notifications and dolphin.
+// The heap is counted here as well, every malloc of the app and the fake SDK goes through it.
+
+#include "t5577_harness.h"
+
+#include <cli/cli.h>
+#include <dolphin/dolphin.h>
+#include <notification/notification_messages.h>
+#include <toolbox/args.h>
+
+#include <ctype.h>
+#include <unistd.h>
+
+#define HARNESS_HEAP_SIZE   (192 * 1024) // Roughly what a Flipper app has to itself
+#define HEAP_HEADER_SIZE    16 // Keeps the alignment malloc gives
+#define HEAP_TRACKED        0x48454150 // "HEAP"
+#define LOG_LINES           512
+#define LOG_LINE_SIZE       160
+#define NOTIFICATION_LINES  64
+#define CLI_COMMANDS        4
+#define CLI_COMMAND_SIZE    32
+
+// Heap
+
+void* __real_malloc(size_t size);
+void* __real_realloc(void* pointer, size_t size);
+void __real_free(void* pointer);
+
+static size_t heap_in_use;
+static size_t heap_peak;
+static size_t heap_peak_total; // Since the start, for memmgr_get_minimum_free_heap
+static bool heap_paused;
+
+typedef struct {
+    size_t size;
+    uint32_t tracked;
+} HeapHeader;
+
+static void heap_add(HeapHeader* header, size_t size) {
+    header->size = size;
+    header->tracked = heap_paused ? 0 : HEAP_TRACKED;
+    if(heap_paused) return;
+    heap_in_use += size;
+    if(heap_in_use > heap_peak) heap_peak = heap_in_use;
+    if(heap_in_use > heap_peak_total) heap_peak_total = heap_in_use;
+}
+
+static void heap_remove(HeapHeader* header) {
+    if(header->tracked == HEAP_TRACKED) heap_in_use -= header->size;
+}
+
+void* __wrap_malloc(size_t size) {
+    HeapHeader* header = __real_malloc(HEAP_HEADER_SIZE + size);
+    if(!header) return NULL;
+    heap_add(header, size);
+    return (uint8_t*)header + HEAP_HEADER_SIZE;
+}
+
+void __wrap_free(void* pointer) {
+    if(!pointer) return;
+    HeapHeader* header = (HeapHeader*)((uint8_t*)pointer - HEAP_HEADER_SIZE);
+    heap_remove(header);
+    __real_free(header);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    void* pointer = __wrap_malloc(count * size);
+    if(pointer) memset(pointer, 0, count * size);
+    return pointer;
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    if(!pointer) return __wrap_malloc(size);
+    HeapHeader* header = (HeapHeader*)((uint8_t*)pointer - HEAP_HEADER_SIZE);
+    heap_remove(header);
+    header = __real_realloc(header, HEAP_HEADER_SIZE + size);
+    if(!header) return NULL;
+    heap_add(header, size);
+    return (uint8_t*)header + HEAP_HEADER_SIZE;
+}
+
+size_t harness_heap_in_use(void) {
+    return heap_in_use;
+}
+
+size_t harness_heap_peak(void) {
+    return heap_peak;
+}
+
+void harness_heap_reset_peak(void) {
+    heap_peak = heap_in_use;
+}
+
+void harness_heap_pause(bool paused) {
+    heap_paused = paused;
+}
+
+size_t memmgr_get_free_heap(void) {
+    return heap_in_use < HARNESS_HEAP_SIZE ? HARNESS_HEAP_SIZE - heap_in_use : 0;
+}
+
+size_t memmgr_get_minimum_free_heap(void) {
+    return heap_peak_total < HARNESS_HEAP_SIZE ? HARNESS_HEAP_SIZE - heap_peak_total : 0;
+}
+
+// Checks
+
+_Noreturn void furi_crash_at(const char* file, int line, const char* expression) {
+    fflush(stdout);
+    fprintf(stderr, "furi_check failed at %s:%d: %s\n", file, line, expression);
+    exit(EXIT_FAILURE);
+}
+
+// Log
+
+static char log_lines[LOG_LINES][LOG_LINE_SIZE];
+static size_t log_count;
+
+void furi_log_print_format(FuriLogLevel level, const char* tag, const char* format, ...) {
+    static const char levels[] = "?EWID";
+    char* line = log_lines[log_count++ % LOG_LINES];
+    int length = snprintf(line, LOG_LINE_SIZE, "[%c][%s] ", levels[level], tag);
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line + length, LOG_LINE_SIZE - length, format, args);
+    va_end(args);
+    // The trace goes to stderr, stdout is the CLI reply while a command runs
+    if(harness_verbose()) fprintf(stderr, "    %s\n", line);
+}
+
+bool harness_log_contains(const char* text) {
+    size_t first = log_count > LOG_LINES ? log_count - LOG_LINES : 0;
+    for(size_t i = first; i < log_count; i++) {
+        if(strstr(log_lines[i % LOG_LINES], text)) return true;
+    }
+    return false;
+}
+
+void harness_log_clear(void) {
+    log_count = 0;
+}
+
+// Strings
+
+struct FuriString {
+    char* data;
+    size_t size;
+    size_t capacity;
+};
+
+static void furi_string_reserve(FuriString* string, size_t size) {
+    if(size + 1 <= string->capacity) return;
+    while(string->capacity < size + 1) string->capacity *= 2;
+    string->data = realloc(string->data, string->capacity);
+}
+
+FuriString* furi_string_alloc(void) {
+    FuriString* string = malloc(sizeof(FuriString));
+    string->capacity = 16;
+    string->data = malloc(string->capacity);
+    string->data[0] = '\0';
+    string->size = 0;
+    return string;
+}
+
+void furi_string_free(FuriString* string) {
+    free(string->data);
+    free(string);
+}
+
+void furi_string_reset(FuriString* string) {
+    string->size = 0;
+    string->data[0] = '\0';
+}
+
+void furi_string_set_str(FuriString* string, const char* text) {
+    size_t size = strlen(text);
+    furi_string_reserve(string, size);
+    memmove(string->data, text, size + 1);
+    string->size = size;
+}
+
+void furi_string_set_string(FuriString* string, const FuriString* source) {
+    furi_string_set_str(string, source->data);
+}
+
+void furi_string_cat_str(FuriString* string, const char* text) {
+    size_t size = strlen(text);
+    furi_string_reserve(string, string->size + size);
+    memcpy(string->data + string->size, text, size + 1);
+    string->size += size;
+}
+
+void furi_string_cat_string(FuriString* string, const FuriString* source) {
+    furi_string_cat_str(string, source->data);
+}
+
+static int furi_string_cat_vprintf(FuriString* string, const char* format, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    int size = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+    if(size < 0) return size;
+    furi_string_reserve(string, string->size + size);
+    vsnprintf(string->data + string->size, size + 1, format, args);
+    string->size += size;
+    return size;
+}
+
+int furi_string_printf(FuriString* string, const char* format, ...) {
+    furi_string_reset(string);
+    va_list args;
+    va_start(args, format);
+    int size = furi_string_cat_vprintf(string, format, args);
+    va_end(args);
+    return size;
+}
+
+int furi_string_cat_printf(FuriString* string, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int size = furi_string_cat_vprintf(string, format, args);
+    va_end(args);
+    return size;
+}
+
+const char* furi_string_get_cstr(const FuriString* string) {
+    return string->data;
+}
+
+size_t furi_string_size(const FuriString* string) {
+    return string->size;
+}
+
+bool furi_string_empty(const FuriString* string) {
+    return string->size == 0;
+}
+
+void furi_string_trim(FuriString* string) {
+    size_t start = 0;
+    while(start < string->size && isspace((unsigned char)string->data[start])) start++;
+    size_t end = string->size;
+    while(end > start && isspace((unsigned char)string->data[end - 1])) end--;
+    memmove(string->data, string->data + start, end - start);
+    string->size = end - start;
+    string->data[string->size] = '\0';
+}
+
+bool args_read_string_and_trim(FuriString* args, FuriString* word) {
+    furi_string_trim(args);
+    if(furi_string_empty(args)) return false;
+    size_t length = strcspn(args->data, " \t");
+    furi_string_reserve(word, length);
+    memcpy(word->data, args->data, length);
+    word->data[length] = '\0';
+    word->size = length;
+    furi_string_set_str(args, args->data + length);
+    furi_string_trim(args);
+    return true;
+}
+
+// Time and timers
+
+static uint64_t now_us;
+
+struct FuriTimer {
+    FuriTimerCallback callback;
+    FuriTimerType type;
+    void* context;
+    bool running;
+    uint64_t due_us;
+    uint64_t period_us;
+    FuriTimer* next;
+};
+
+static FuriTimer* timers;
+
+uint64_t harness_now_us(void) {
+    return now_us;
+}
+
+void harness_advance_us(uint64_t us) {
+    now_us += us;
+}
+
+uint32_t furi_get_tick(void) {
+    return (uint32_t)(now_us / 1000);
+}
+
+uint32_t furi_ms_to_ticks(uint32_t milliseconds) {
+    return milliseconds;
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    now_us += (uint64_t)milliseconds * 1000;
+}
+
+void furi_delay_us(uint32_t microseconds) {
+    now_us += microseconds;
+}
+
+FuriTimer* furi_timer_alloc(FuriTimerCallback callback, FuriTimerType type, void* context) {
+    FuriTimer* timer = malloc(sizeof(FuriTimer));
+    memset(timer, 0, sizeof(FuriTimer));
+    timer->callback = callback;
+    timer->type = type;
+    timer->context = context;
+    timer->next = timers;
+    timers = timer;
+    return timer;
+}
+
+void furi_timer_free(FuriTimer* timer) {
+    FuriTimer** link = &timers;
+    while(*link != timer) link = &(*link)->next;
+    *link = timer->next;
+    free(timer);
+}
+
+FuriStatus furi_timer_start(FuriTimer* timer, uint32_t ticks) {
+    timer->running = true;
+    timer->period_us = (uint64_t)ticks * 1000;
+    timer->due_us = now_us + timer->period_us;
+    return FuriStatusOk;
+}
+
+FuriStatus furi_timer_stop(FuriTimer* timer) {
+    timer->running = false;
+    return FuriStatusOk;
+}
+
+bool harness_timer_fire_next(uint64_t until_us) {
+    FuriTimer* first = NULL;
+    for(FuriTimer* timer = timers; timer; timer = timer->next) {
+        if(timer->running && timer->due_us <= until_us &&
+           (first == NULL || timer->due_us < first->due_us)) {
+            first = timer;
+        }
+    }
+    if(first == NULL) return false;
+    // A timer that is late because the app was blocked fires as soon as it can
+    if(first->due_us > now_us) now_us = first->due_us;
+    if(first->type == FuriTimerTypePeriodic) {
+        first->due_us += first->period_us;
+        if(first->due_us <= now_us) first->due_us = now_us + first->period_us;
+    } else {
+        first->running = false;
+    }
+    first->callback(first->context);
+    return true;
+}
+
+size_t harness_timers_running(void) {
+    size_t count = 0;
+    for(FuriTimer* timer = timers; timer; timer = timer->next) {
+        if(timer->running) count++;
+    }
+    return count;
+}
+
+// Mutexes. Only one thread runs, so a mutex that is taken stays taken while anyone waits for it.
+
+struct FuriMutex {
+    bool taken;
+};
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    UNUSED(type);
+    FuriMutex* mutex = malloc(sizeof(FuriMutex));
+    mutex->taken = false;
+    return mutex;
+}
+
+void furi_mutex_free(FuriMutex* mutex) {
+    if(mutex->taken) harness_fail("A mutex was freed while it was taken");
+    free(mutex);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout) {
+    if(!mutex->taken) {
+        mutex->taken = true;
+        return FuriStatusOk;
+    }
+    // Nothing else runs that could release it
+    furi_check(timeout != FuriWaitForever);
+    return FuriStatusErrorTimeout;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* mutex) {
+    if(!mutex->taken) {
+        harness_fail("A mutex was released that wasn't taken");
+        return FuriStatusError;
+    }
+    mutex->taken = false;
+    return FuriStatusOk;
+}
+
+// Records
+
+static const char* const record_names[] = {
+    RECORD_GUI,
+    RECORD_STORAGE,
+    RECORD_DIALOGS,
+    RECORD_NOTIFICATION,
+    RECORD_CLI,
+};
+static uint32_t record_opens[COUNT_OF(record_names)];
+static uint8_t record_objects[COUNT_OF(record_names)]; // Only the address is used
+
+void* furi_record_open(const char* name) {
+    for(size_t i = 0; i < COUNT_OF(record_names); i++) {
+        if(strcmp(record_names[i], name) == 0) {
+            record_opens[i]++;
+            return &record_objects[i];
+        }
+    }
+    harness_fail("No record %s", name);
+    return NULL;
+}
+
+void furi_record_close(const char* name) {
+    for(size_t i = 0; i < COUNT_OF(record_names); i++) {
+        if(strcmp(record_names[i], name) == 0) {
+            if(record_opens[i] == 0) harness_fail("Record %s closed more often than opened", name);
+            if(record_opens[i] > 0) record_opens[i]--;
+            return;
+        }
+    }
+    harness_fail("No record %s", name);
+}
+
+const char* harness_record_open_name(void) {
+    for(size_t i = 0; i < COUNT_OF(record_names); i++) {
+        if(record_opens[i]) return record_names[i];
+    }
+    return NULL;
+}
+
+// Notifications
+
+const NotificationSequence sequence_success = {"success"};
+const NotificationSequence sequence_error = {"error"};
+const NotificationSequence sequence_blink_stop = {"blink_stop"};
+const NotificationSequence sequence_blink_start_cyan = {"blink_start_cyan"};
+const NotificationSequence sequence_blink_start_magenta = {"blink_start_magenta"};
+
+static const char* notifications[NOTIFICATION_LINES];
+static size_t notification_count;
+
+void notification_message(NotificationApp* app, const NotificationSequence* sequence) {
+    UNUSED(app);
+    notifications[notification_count++ % NOTIFICATION_LINES] = sequence->name;
+}
+
+bool harness_notification_seen(const char* name) {
+    size_t first = notification_count > NOTIFICATION_LINES ?
+                       notification_count - NOTIFICATION_LINES :
+                       0;
+    for(size_t i = first; i < notification_count; i++) {
+        if(strcmp(notifications[i % NOTIFICATION_LINES], name) == 0) return true;
+    }
+    return false;
+}
+
+void harness_notification_clear(void) {
+    notification_count = 0;
+}
+
+void dolphin_deed(DolphinDeed deed) {
+    UNUSED(deed);
+}
+
+// CLI
+
+typedef struct {
+    char name[CLI_COMMAND_SIZE];
+    CliCallback callback;
+    void* context;
+} CliCommand;
+
+static CliCommand cli_commands[CLI_COMMANDS];
+
+void cli_add_command(
+    Cli* cli,
+    const char* name,
+    CliCommandFlag flags,
+    CliCallback callback,
+    void* context) {
+    UNUSED(cli);
+    UNUSED(flags);
+    for(size_t i = 0; i < CLI_COMMANDS; i++) {
+        if(cli_commands[i].callback == NULL) {
+            snprintf(cli_commands[i].name, CLI_COMMAND_SIZE, "%s", name);
+            cli_commands[i].callback = callback;
+            cli_commands[i].context = context;
+            return;
+        }
+    }
+    harness_fail("No room for the CLI command %s", name);
+}
+
+void cli_delete_command(Cli* cli, const char* name) {
+    UNUSED(cli);
+    for(size_t i = 0; i < CLI_COMMANDS; i++) {
+        if(cli_commands[i].callback && strcmp(cli_commands[i].name, name) == 0) {
+            memset(&cli_commands[i], 0, sizeof(CliCommand));
+            return;
+        }
+    }
+    harness_fail("The CLI command %s was deleted but never added", name);
+}
+
+void harness_cli_run(const char* line, char* reply, size_t reply_size) {
+    size_t length = strcspn(line, " ");
+    CliCommand* command = NULL;
+    for(size_t i = 0; i < CLI_COMMANDS; i++) {
+        if(cli_commands[i].callback && strlen(cli_commands[i].name) == length &&
+           strncmp(cli_commands[i].name, line, length) == 0) {
+            command = &cli_commands[i];
+        }
+    }
+    if(command == NULL) {
+        snprintf(reply, reply_size, "`%.*s` command not found", (int)length, line);
+        return;
+    }
+
+    // The command prints its reply, which goes to a file here instead of the USB serial
+    FILE* output = tmpfile();
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    dup2(fileno(output), STDOUT_FILENO);
+    FuriString* args = furi_string_alloc();
+    furi_string_set_str(args, line + length);
+    furi_string_trim(args);
+    command->callback(NULL, args, command->context);
+    furi_string_free(args);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    rewind(output);
+    size_t size = fread(reply, 1, reply_size - 1, output);
+    fclose(output);
+    while(size > 0 && (reply[size - 1] == '\n' || reply[size - 1] == '\r')) size--;
+    reply[size] = '\0';
+}
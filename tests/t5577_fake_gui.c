@@ -0,0 +1,1082 @@
+// The GUI on the host, for t5577_harness: views, the view dispatcher, the modules the app uses and
+// the dialogs. The view dispatcher behaves like the firmware's: switching calls the old view's
+// exit and the new view's enter, custom events go to the current view before the app, and an
+// unhandled Back goes to the view's previous callback. Instead of waiting for input, its run loop
+// plays the script, and a frame is drawn once the events a step caused have all been handled.
+
+#include "t5577_harness.h"
+
+#include <applications/services/dialogs/dialogs.h>
+#include <gui/modules/byte_input.h>
+#include <gui/modules/submenu.h>
+#include <gui/modules/text_input.h>
+#include <gui/modules/variable_item_list.h>
+#include <gui/modules/widget.h>
+#include <gui/view_dispatcher.h>
+
+#include "t5577_writer_icons.h"
+
+#include <ctype.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define DISPATCHER_VIEWS      16
+#define DISPATCHER_QUEUE      64
+#define FRAMEBUFFER_CALLBACKS 4
+#define SCREEN_SIZE           512
+#define LABEL_SIZE            64
+#define SUBMENU_ITEMS         16
+#define VARIABLE_ITEMS        16
+#define ANSWERS               16
+#define SUBMENU_ROWS          4 // Items the firmware's submenu shows at once
+
+const Icon I_icon = {"icon", 10, 10};
+const Icon I_NFC_manual_60x50 = {"NFC_manual_60x50", 60, 50};
+const Icon I_DolphinSuccess_91x55 = {"DolphinSuccess_91x55", 91, 55};
+
+static uint64_t real_us(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
+// Canvas: only the strings and icons are kept
+
+struct Canvas {
+    char screen[SCREEN_SIZE];
+};
+
+static Canvas canvas;
+static char last_screen[SCREEN_SIZE];
+
+static void canvas_add(Canvas* canvas, const char* text) {
+    size_t length = strlen(canvas->screen);
+    snprintf(
+        canvas->screen + length,
+        SCREEN_SIZE - length,
+        "%s%s",
+        length ? " | " : "",
+        text);
+}
+
+void canvas_set_bitmap_mode(Canvas* canvas, bool alpha) {
+    UNUSED(canvas);
+    UNUSED(alpha);
+}
+
+void canvas_set_font(Canvas* canvas, Font font) {
+    UNUSED(canvas);
+    UNUSED(font);
+}
+
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon) {
+    UNUSED(x);
+    UNUSED(y);
+    char text[LABEL_SIZE];
+    snprintf(text, sizeof(text), "[%s]", icon->name);
+    canvas_add(canvas, text);
+}
+
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* text) {
+    UNUSED(x);
+    UNUSED(y);
+    canvas_add(canvas, text);
+}
+
+void canvas_draw_str_aligned(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    Align horizontal,
+    Align vertical,
+    const char* text) {
+    UNUSED(horizontal);
+    UNUSED(vertical);
+    canvas_draw_str(canvas, x, y, text);
+}
+
+const char* harness_gui_screen(void) {
+    return last_screen;
+}
+
+// Framebuffer callbacks, called after every frame like the GUI service does
+
+typedef struct {
+    GuiCanvasCommitCallback callback;
+    void* context;
+} FramebufferCallback;
+
+static FramebufferCallback framebuffer_callbacks[FRAMEBUFFER_CALLBACKS];
+
+void gui_add_framebuffer_callback(Gui* gui, GuiCanvasCommitCallback callback, void* context) {
+    UNUSED(gui);
+    for(size_t i = 0; i < FRAMEBUFFER_CALLBACKS; i++) {
+        if(framebuffer_callbacks[i].callback == NULL) {
+            framebuffer_callbacks[i] = (FramebufferCallback){callback, context};
+            return;
+        }
+    }
+    harness_fail("No room for another framebuffer callback");
+}
+
+void gui_remove_framebuffer_callback(Gui* gui, GuiCanvasCommitCallback callback, void* context) {
+    UNUSED(gui);
+    for(size_t i = 0; i < FRAMEBUFFER_CALLBACKS; i++) {
+        if(framebuffer_callbacks[i].callback == callback &&
+           framebuffer_callbacks[i].context == context) {
+            framebuffer_callbacks[i].callback = NULL;
+            return;
+        }
+    }
+    harness_fail("A framebuffer callback was removed that wasn't added");
+}
+
+// View
+
+struct View {
+    ViewDrawCallback draw_callback;
+    ViewInputCallback input_callback;
+    ViewCustomCallback custom_callback;
+    ViewNavigationCallback previous_callback;
+    ViewCallback enter_callback;
+    ViewCallback exit_callback;
+    void* context;
+    void* model;
+    HarnessViewHooks hooks;
+    ViewDispatcher* view_dispatcher; // The dispatcher the view was added to
+};
+
+View* view_alloc(void) {
+    View* view = malloc(sizeof(View));
+    memset(view, 0, sizeof(View));
+    return view;
+}
+
+void view_free(View* view) {
+    if(view->view_dispatcher) harness_fail("A view was freed while it was still added");
+    view_free_model(view);
+    free(view);
+}
+
+void view_set_draw_callback(View* view, ViewDrawCallback callback) {
+    view->draw_callback = callback;
+}
+
+void view_set_input_callback(View* view, ViewInputCallback callback) {
+    view->input_callback = callback;
+}
+
+void view_set_custom_callback(View* view, ViewCustomCallback callback) {
+    view->custom_callback = callback;
+}
+
+void view_set_previous_callback(View* view, ViewNavigationCallback callback) {
+    view->previous_callback = callback;
+}
+
+void view_set_enter_callback(View* view, ViewCallback callback) {
+    view->enter_callback = callback;
+}
+
+void view_set_exit_callback(View* view, ViewCallback callback) {
+    view->exit_callback = callback;
+}
+
+void view_set_context(View* view, void* context) {
+    view->context = context;
+}
+
+void view_allocate_model(View* view, ViewModelType type, size_t size) {
+    UNUSED(type);
+    furi_check(view->model == NULL);
+    view->model = malloc(size);
+    memset(view->model, 0, size);
+}
+
+void view_free_model(View* view) {
+    free(view->model);
+    view->model = NULL;
+}
+
+void* view_get_model(View* view) {
+    return view->model;
+}
+
+void view_set_harness_hooks(View* view, const HarnessViewHooks* hooks) {
+    view->hooks = *hooks;
+}
+
+// View dispatcher
+
+struct ViewDispatcher {
+    struct {
+        uint32_t id;
+        View* view;
+    } views[DISPATCHER_VIEWS];
+    View* current_view;
+    uint32_t queue[DISPATCHER_QUEUE];
+    size_t queue_head;
+    size_t queue_count;
+    ViewDispatcherCustomEventCallback custom_event_callback;
+    void* event_context;
+    bool running;
+    bool dirty; // The current view asked to be drawn
+};
+
+static ViewDispatcher* active; // The app's dispatcher, while it runs
+
+static void view_dispatcher_update(View* view) {
+    ViewDispatcher* view_dispatcher = view->view_dispatcher;
+    if(view_dispatcher && view_dispatcher->current_view == view) view_dispatcher->dirty = true;
+}
+
+void view_commit_model(View* view, bool update) {
+    if(update) view_dispatcher_update(view);
+}
+
+ViewDispatcher* view_dispatcher_alloc(void) {
+    ViewDispatcher* view_dispatcher = malloc(sizeof(ViewDispatcher));
+    memset(view_dispatcher, 0, sizeof(ViewDispatcher));
+    return view_dispatcher;
+}
+
+void view_dispatcher_free(ViewDispatcher* view_dispatcher) {
+    for(size_t i = 0; i < DISPATCHER_VIEWS; i++) {
+        if(view_dispatcher->views[i].view) {
+            harness_fail(
+                "The view dispatcher was freed with %s still added",
+                harness_view_name(view_dispatcher->views[i].id));
+        }
+    }
+    if(active == view_dispatcher) active = NULL;
+    free(view_dispatcher);
+}
+
+void view_dispatcher_enable_queue(ViewDispatcher* view_dispatcher) {
+    UNUSED(view_dispatcher);
+}
+
+void view_dispatcher_attach_to_gui(
+    ViewDispatcher* view_dispatcher,
+    Gui* gui,
+    ViewDispatcherType type) {
+    UNUSED(gui);
+    UNUSED(type);
+    active = view_dispatcher;
+}
+
+void view_dispatcher_set_event_callback_context(ViewDispatcher* view_dispatcher, void* context) {
+    view_dispatcher->event_context = context;
+}
+
+void view_dispatcher_set_custom_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherCustomEventCallback callback) {
+    view_dispatcher->custom_event_callback = callback;
+}
+
+void view_dispatcher_add_view(ViewDispatcher* view_dispatcher, uint32_t view_id, View* view) {
+    size_t free_slot = DISPATCHER_VIEWS;
+    for(size_t i = 0; i < DISPATCHER_VIEWS; i++) {
+        if(view_dispatcher->views[i].view && view_dispatcher->views[i].id == view_id) {
+            harness_fail("%s was added twice", harness_view_name(view_id));
+            return;
+        }
+        if(view_dispatcher->views[i].view == NULL && free_slot == DISPATCHER_VIEWS) free_slot = i;
+    }
+    furi_check(free_slot < DISPATCHER_VIEWS);
+    view_dispatcher->views[free_slot].id = view_id;
+    view_dispatcher->views[free_slot].view = view;
+    view->view_dispatcher = view_dispatcher;
+}
+
+static uint32_t view_dispatcher_id(ViewDispatcher* view_dispatcher, View* view) {
+    for(size_t i = 0; i < DISPATCHER_VIEWS; i++) {
+        if(view && view_dispatcher->views[i].view == view) return view_dispatcher->views[i].id;
+    }
+    return VIEW_NONE;
+}
+
+static void view_dispatcher_set_current_view(ViewDispatcher* view_dispatcher, View* view) {
+    if(view_dispatcher->current_view && view_dispatcher->current_view->exit_callback) {
+        view_dispatcher->current_view->exit_callback(view_dispatcher->current_view->context);
+    }
+    view_dispatcher->current_view = view;
+    if(view) {
+        view_dispatcher->dirty = true;
+        // The enter callback can switch again, like the firmware allows
+        if(view->enter_callback) view->enter_callback(view->context);
+    }
+}
+
+void view_dispatcher_remove_view(ViewDispatcher* view_dispatcher, uint32_t view_id) {
+    for(size_t i = 0; i < DISPATCHER_VIEWS; i++) {
+        View* view = view_dispatcher->views[i].view;
+        if(view && view_dispatcher->views[i].id == view_id) {
+            if(view_dispatcher->current_view == view) {
+                view_dispatcher_set_current_view(view_dispatcher, NULL);
+            }
+            view->view_dispatcher = NULL;
+            view_dispatcher->views[i].view = NULL;
+            return;
+        }
+    }
+    harness_fail("%s was removed but never added", harness_view_name(view_id));
+}
+
+void view_dispatcher_switch_to_view(ViewDispatcher* view_dispatcher, uint32_t view_id) {
+    if(view_id == VIEW_NONE) {
+        view_dispatcher_set_current_view(view_dispatcher, NULL);
+        return;
+    }
+    if(view_id == VIEW_IGNORE) return;
+    for(size_t i = 0; i < DISPATCHER_VIEWS; i++) {
+        if(view_dispatcher->views[i].view && view_dispatcher->views[i].id == view_id) {
+            view_dispatcher_set_current_view(view_dispatcher, view_dispatcher->views[i].view);
+            return;
+        }
+    }
+    harness_fail("Switched to %s, which wasn't added", harness_view_name(view_id));
+}
+
+void view_dispatcher_send_custom_event(ViewDispatcher* view_dispatcher, uint32_t event) {
+    if(view_dispatcher->queue_count == DISPATCHER_QUEUE) {
+        harness_fail(
+            "The event queue is full, custom event %lu was dropped", (unsigned long)event);
+        return;
+    }
+    size_t tail = (view_dispatcher->queue_head + view_dispatcher->queue_count) % DISPATCHER_QUEUE;
+    view_dispatcher->queue[tail] = event;
+    view_dispatcher->queue_count++;
+}
+
+static void view_dispatcher_handle_custom_event(ViewDispatcher* view_dispatcher, uint32_t event) {
+    View* view = view_dispatcher->current_view;
+    bool consumed = false;
+    if(view && view->custom_callback) consumed = view->custom_callback(event, view->context);
+    if(!consumed && view_dispatcher->custom_event_callback) {
+        view_dispatcher->custom_event_callback(view_dispatcher->event_context, event);
+    }
+}
+
+static void view_dispatcher_draw(ViewDispatcher* view_dispatcher) {
+    View* view = view_dispatcher->current_view;
+    view_dispatcher->dirty = false;
+    canvas.screen[0] = '\0';
+    uint64_t start_us = real_us();
+    uint64_t start_device_us = harness_now_us();
+    if(view->draw_callback) view->draw_callback(&canvas, view->model);
+    uint64_t elapsed_us = real_us() - start_us;
+    uint64_t elapsed_device_us = harness_now_us() - start_device_us;
+    memcpy(last_screen, canvas.screen, SCREEN_SIZE);
+    for(size_t i = 0; i < FRAMEBUFFER_CALLBACKS; i++) {
+        FramebufferCallback* framebuffer = &framebuffer_callbacks[i];
+        if(framebuffer->callback) {
+            framebuffer->callback(NULL, 0, CanvasOrientationHorizontal, framebuffer->context);
+        }
+    }
+    harness_frame(
+        view_dispatcher_id(view_dispatcher, view), elapsed_us, elapsed_device_us);
+}
+
+void harness_gui_process(void) {
+    ViewDispatcher* view_dispatcher = active;
+    while(view_dispatcher && view_dispatcher->running) {
+        if(view_dispatcher->queue_count) {
+            uint32_t event = view_dispatcher->queue[view_dispatcher->queue_head];
+            view_dispatcher->queue_head = (view_dispatcher->queue_head + 1) % DISPATCHER_QUEUE;
+            view_dispatcher->queue_count--;
+            view_dispatcher_handle_custom_event(view_dispatcher, event);
+        } else if(view_dispatcher->dirty && view_dispatcher->current_view) {
+            view_dispatcher_draw(view_dispatcher);
+        } else {
+            break;
+        }
+    }
+}
+
+void harness_gui_input(InputKey key) {
+    ViewDispatcher* view_dispatcher = active;
+    if(view_dispatcher == NULL || !view_dispatcher->running) return;
+    View* view = view_dispatcher->current_view;
+    InputEvent event = {key, InputTypeShort};
+    bool consumed = false;
+    if(view && view->input_callback) consumed = view->input_callback(&event, view->context);
+    if(!consumed && view && key == InputKeyBack) {
+        uint32_t view_id = view->previous_callback ? view->previous_callback(view->context) :
+                                                     VIEW_IGNORE;
+        if(view_id == VIEW_NONE) {
+            view_dispatcher_stop(view_dispatcher);
+        } else if(view_id != VIEW_IGNORE) {
+            view_dispatcher_switch_to_view(view_dispatcher, view_id);
+        }
+    }
+}
+
+void view_dispatcher_run(ViewDispatcher* view_dispatcher) {
+    view_dispatcher->running = true;
+    harness_gui_process();
+    while(view_dispatcher->running) {
+        if(!harness_step()) {
+            harness_fail("The script ended with the app still open");
+            view_dispatcher_stop(view_dispatcher);
+        }
+    }
+    view_dispatcher->queue_count = 0;
+}
+
+void view_dispatcher_stop(ViewDispatcher* view_dispatcher) {
+    view_dispatcher->running = false;
+}
+
+bool harness_gui_running(void) {
+    return active && active->running;
+}
+
+uint32_t harness_gui_current(void) {
+    if(active == NULL) return VIEW_NONE;
+    return view_dispatcher_id(active, active->current_view);
+}
+
+const HarnessViewHooks* harness_gui_hooks(void) {
+    if(active == NULL || active->current_view == NULL) return NULL;
+    const HarnessViewHooks* hooks = &active->current_view->hooks;
+    return hooks->module ? hooks : NULL;
+}
+
+// Submenu
+
+typedef struct {
+    char label[LABEL_SIZE];
+    uint32_t index;
+    SubmenuItemCallback callback;
+    void* context;
+} SubmenuItem;
+
+struct Submenu {
+    View* view;
+    SubmenuItem items[SUBMENU_ITEMS];
+    int32_t count;
+    int32_t cursor;
+};
+
+static void submenu_draw_callback(Canvas* canvas, void* model) {
+    Submenu* submenu = *(Submenu**)model;
+    int32_t first = submenu->cursor >= SUBMENU_ROWS ? submenu->cursor - SUBMENU_ROWS + 1 : 0;
+    for(int32_t i = first; i < submenu->count && i < first + SUBMENU_ROWS; i++) {
+        char text[LABEL_SIZE + 2];
+        snprintf(
+            text, sizeof(text), "%s%s", i == submenu->cursor ? "> " : "", submenu->items[i].label);
+        canvas_draw_str(canvas, 0, 0, text);
+    }
+}
+
+static bool submenu_input_callback(InputEvent* event, void* context) {
+    Submenu* submenu = context;
+    if(submenu->count == 0) return false;
+    switch(event->key) {
+    case InputKeyUp:
+        submenu->cursor = (submenu->cursor + submenu->count - 1) % submenu->count;
+        break;
+    case InputKeyDown:
+        submenu->cursor = (submenu->cursor + 1) % submenu->count;
+        break;
+    case InputKeyOk: {
+        SubmenuItem* item = &submenu->items[submenu->cursor];
+        if(item->callback) item->callback(item->context, item->index);
+        return true;
+    }
+    default:
+        return false;
+    }
+    view_dispatcher_update(submenu->view);
+    return true;
+}
+
+static int32_t submenu_find(void* module, const char* label) {
+    Submenu* submenu = module;
+    for(int32_t i = 0; i < submenu->count; i++) {
+        if(strcmp(submenu->items[i].label, label) == 0) return i;
+    }
+    return -1;
+}
+
+static int32_t submenu_cursor(void* module) {
+    return ((Submenu*)module)->cursor;
+}
+
+Submenu* submenu_alloc(void) {
+    Submenu* submenu = malloc(sizeof(Submenu));
+    memset(submenu, 0, sizeof(Submenu));
+    submenu->view = view_alloc();
+    view_allocate_model(submenu->view, ViewModelTypeLocking, sizeof(Submenu*));
+    *(Submenu**)view_get_model(submenu->view) = submenu;
+    view_set_context(submenu->view, submenu);
+    view_set_draw_callback(submenu->view, submenu_draw_callback);
+    view_set_input_callback(submenu->view, submenu_input_callback);
+    HarnessViewHooks hooks = {submenu_find, submenu_cursor, NULL, NULL, submenu};
+    view_set_harness_hooks(submenu->view, &hooks);
+    return submenu;
+}
+
+void submenu_free(Submenu* submenu) {
+    view_free(submenu->view);
+    free(submenu);
+}
+
+View* submenu_get_view(Submenu* submenu) {
+    return submenu->view;
+}
+
+void submenu_add_item(
+    Submenu* submenu,
+    const char* label,
+    uint32_t index,
+    SubmenuItemCallback callback,
+    void* callback_context) {
+    furi_check(submenu->count < SUBMENU_ITEMS);
+    SubmenuItem* item = &submenu->items[submenu->count++];
+    snprintf(item->label, LABEL_SIZE, "%s", label);
+    item->index = index;
+    item->callback = callback;
+    item->context = callback_context;
+}
+
+void submenu_reset(Submenu* submenu) {
+    submenu->count = 0;
+    submenu->cursor = 0;
+}
+
+// Variable item list
+
+struct VariableItem {
+    char label[LABEL_SIZE];
+    uint8_t values_count;
+    uint8_t current_value_index;
+    char current_value_text[LABEL_SIZE];
+    VariableItemChangeCallback change_callback;
+    void* context;
+};
+
+struct VariableItemList {
+    View* view;
+    VariableItem items[VARIABLE_ITEMS];
+    int32_t count;
+    int32_t cursor;
+    VariableItemListEnterCallback enter_callback;
+    void* enter_context;
+};
+
+static void variable_item_list_draw_callback(Canvas* canvas, void* model) {
+    VariableItemList* list = *(VariableItemList**)model;
+    int32_t first = list->cursor >= SUBMENU_ROWS ? list->cursor - SUBMENU_ROWS + 1 : 0;
+    for(int32_t i = first; i < list->count && i < first + SUBMENU_ROWS; i++) {
+        VariableItem* item = &list->items[i];
+        char text[2 * LABEL_SIZE + 8];
+        snprintf(
+            text,
+            sizeof(text),
+            "%s%s: %s",
+            i == list->cursor ? "> " : "",
+            item->label,
+            item->current_value_text);
+        canvas_draw_str(canvas, 0, 0, text);
+    }
+}
+
+static bool variable_item_list_input_callback(InputEvent* event, void* context) {
+    VariableItemList* list = context;
+    if(list->count == 0) return false;
+    VariableItem* item = &list->items[list->cursor];
+    switch(event->key) {
+    case InputKeyUp:
+        list->cursor = (list->cursor + list->count - 1) % list->count;
+        break;
+    case InputKeyDown:
+        list->cursor = (list->cursor + 1) % list->count;
+        break;
+    case InputKeyLeft:
+        if(item->current_value_index == 0) return true;
+        item->current_value_index--;
+        if(item->change_callback) item->change_callback(item);
+        break;
+    case InputKeyRight:
+        if(item->current_value_index + 1 >= item->values_count) return true;
+        item->current_value_index++;
+        if(item->change_callback) item->change_callback(item);
+        break;
+    case InputKeyOk:
+        if(list->enter_callback) list->enter_callback(list->enter_context, list->cursor);
+        return true;
+    default:
+        return false;
+    }
+    view_dispatcher_update(list->view);
+    return true;
+}
+
+static int32_t variable_item_list_find(void* module, const char* label) {
+    VariableItemList* list = module;
+    for(int32_t i = 0; i < list->count; i++) {
+        if(strcmp(list->items[i].label, label) == 0) return i;
+    }
+    return -1;
+}
+
+static int32_t variable_item_list_cursor(void* module) {
+    return ((VariableItemList*)module)->cursor;
+}
+
+static const char* variable_item_list_value(void* module, int32_t index) {
+    VariableItemList* list = module;
+    if(index < 0 || index >= list->count) return NULL;
+    return list->items[index].current_value_text;
+}
+
+VariableItemList* variable_item_list_alloc(void) {
+    VariableItemList* list = malloc(sizeof(VariableItemList));
+    memset(list, 0, sizeof(VariableItemList));
+    list->view = view_alloc();
+    view_allocate_model(list->view, ViewModelTypeLocking, sizeof(VariableItemList*));
+    *(VariableItemList**)view_get_model(list->view) = list;
+    view_set_context(list->view, list);
+    view_set_draw_callback(list->view, variable_item_list_draw_callback);
+    view_set_input_callback(list->view, variable_item_list_input_callback);
+    HarnessViewHooks hooks = {
+        variable_item_list_find, variable_item_list_cursor, variable_item_list_value, NULL, list};
+    view_set_harness_hooks(list->view, &hooks);
+    return list;
+}
+
+void variable_item_list_free(VariableItemList* variable_item_list) {
+    view_free(variable_item_list->view);
+    free(variable_item_list);
+}
+
+void variable_item_list_reset(VariableItemList* variable_item_list) {
+    variable_item_list->count = 0;
+    variable_item_list->cursor = 0;
+}
+
+View* variable_item_list_get_view(VariableItemList* variable_item_list) {
+    return variable_item_list->view;
+}
+
+VariableItem* variable_item_list_add(
+    VariableItemList* variable_item_list,
+    const char* label,
+    uint8_t values_count,
+    VariableItemChangeCallback change_callback,
+    void* context) {
+    furi_check(variable_item_list->count < VARIABLE_ITEMS);
+    VariableItem* item = &variable_item_list->items[variable_item_list->count++];
+    memset(item, 0, sizeof(VariableItem));
+    snprintf(item->label, LABEL_SIZE, "%s", label);
+    item->values_count = values_count;
+    item->change_callback = change_callback;
+    item->context = context;
+    return item;
+}
+
+void variable_item_list_set_enter_callback(
+    VariableItemList* variable_item_list,
+    VariableItemListEnterCallback callback,
+    void* context) {
+    variable_item_list->enter_callback = callback;
+    variable_item_list->enter_context = context;
+}
+
+void variable_item_set_current_value_index(VariableItem* item, uint8_t current_value_index) {
+    item->current_value_index = current_value_index;
+}
+
+uint8_t variable_item_get_current_value_index(VariableItem* item) {
+    return item->current_value_index;
+}
+
+void variable_item_set_current_value_text(VariableItem* item, const char* current_value_text) {
+    snprintf(item->current_value_text, LABEL_SIZE, "%s", current_value_text);
+}
+
+void* variable_item_get_context(VariableItem* item) {
+    return item->context;
+}
+
+// Text input: the script types the whole text at once and it is saved
+
+struct TextInput {
+    View* view;
+    char header[LABEL_SIZE];
+    TextInputCallback callback;
+    void* callback_context;
+    char* text_buffer;
+    size_t text_buffer_size;
+};
+
+static void text_input_draw_callback(Canvas* canvas, void* model) {
+    TextInput* text_input = *(TextInput**)model;
+    canvas_draw_str(canvas, 0, 0, text_input->header);
+    if(text_input->text_buffer) canvas_draw_str(canvas, 0, 0, text_input->text_buffer);
+}
+
+static bool text_input_input_callback(InputEvent* event, void* context) {
+    UNUSED(context);
+    return event->key != InputKeyBack; // The keyboard takes every other key
+}
+
+static bool text_input_type(void* module, const char* text) {
+    TextInput* text_input = module;
+    // The keyboard doesn't save an empty text
+    if(text_input->text_buffer == NULL || text[0] == '\0') return false;
+    if(strlen(text) >= text_input->text_buffer_size) return false;
+    snprintf(text_input->text_buffer, text_input->text_buffer_size, "%s", text);
+    if(text_input->callback) text_input->callback(text_input->callback_context);
+    return true;
+}
+
+TextInput* text_input_alloc(void) {
+    TextInput* text_input = malloc(sizeof(TextInput));
+    memset(text_input, 0, sizeof(TextInput));
+    text_input->view = view_alloc();
+    view_allocate_model(text_input->view, ViewModelTypeLocking, sizeof(TextInput*));
+    *(TextInput**)view_get_model(text_input->view) = text_input;
+    view_set_context(text_input->view, text_input);
+    view_set_draw_callback(text_input->view, text_input_draw_callback);
+    view_set_input_callback(text_input->view, text_input_input_callback);
+    HarnessViewHooks hooks = {NULL, NULL, NULL, text_input_type, text_input};
+    view_set_harness_hooks(text_input->view, &hooks);
+    return text_input;
+}
+
+void text_input_free(TextInput* text_input) {
+    view_free(text_input->view);
+    free(text_input);
+}
+
+View* text_input_get_view(TextInput* text_input) {
+    return text_input->view;
+}
+
+void text_input_set_header_text(TextInput* text_input, const char* text) {
+    snprintf(text_input->header, LABEL_SIZE, "%s", text);
+}
+
+void text_input_set_result_callback(
+    TextInput* text_input,
+    TextInputCallback callback,
+    void* callback_context,
+    char* text_buffer,
+    size_t text_buffer_size,
+    bool clear_default_text) {
+    UNUSED(clear_default_text);
+    text_input->callback = callback;
+    text_input->callback_context = callback_context;
+    text_input->text_buffer = text_buffer;
+    text_input->text_buffer_size = text_buffer_size;
+}
+
+// Byte input: the script types the bytes in hex and they are saved
+
+struct ByteInput {
+    View* view;
+    char header[LABEL_SIZE];
+    ByteInputCallback input_callback;
+    ByteChangedCallback changed_callback;
+    void* callback_context;
+    uint8_t* bytes;
+    uint8_t bytes_count;
+};
+
+static void byte_input_draw_callback(Canvas* canvas, void* model) {
+    ByteInput* byte_input = *(ByteInput**)model;
+    canvas_draw_str(canvas, 0, 0, byte_input->header);
+    char text[3 * 8 + 1] = "";
+    for(uint8_t i = 0; i < byte_input->bytes_count && i < 8; i++) {
+        size_t length = strlen(text);
+        snprintf(
+            text + length, sizeof(text) - length, "%s%02X", i ? " " : "", byte_input->bytes[i]);
+    }
+    canvas_draw_str(canvas, 0, 0, text);
+}
+
+static bool byte_input_input_callback(InputEvent* event, void* context) {
+    UNUSED(context);
+    return event->key != InputKeyBack;
+}
+
+static bool byte_input_type(void* module, const char* text) {
+    ByteInput* byte_input = module;
+    uint8_t bytes[8];
+    uint8_t count = 0;
+    while(*text) {
+        if(isspace((unsigned char)*text)) {
+            text++;
+            continue;
+        }
+        if(!isxdigit((unsigned char)text[0]) || !isxdigit((unsigned char)text[1])) return false;
+        if(count == byte_input->bytes_count || count == sizeof(bytes)) return false;
+        char pair[3] = {text[0], text[1], '\0'};
+        bytes[count++] = (uint8_t)strtoul(pair, NULL, 16);
+        text += 2;
+    }
+    if(count != byte_input->bytes_count) return false;
+    memcpy(byte_input->bytes, bytes, count);
+    if(byte_input->changed_callback) byte_input->changed_callback(byte_input->callback_context);
+    if(byte_input->input_callback) byte_input->input_callback(byte_input->callback_context);
+    return true;
+}
+
+ByteInput* byte_input_alloc(void) {
+    ByteInput* byte_input = malloc(sizeof(ByteInput));
+    memset(byte_input, 0, sizeof(ByteInput));
+    byte_input->view = view_alloc();
+    view_allocate_model(byte_input->view, ViewModelTypeLocking, sizeof(ByteInput*));
+    *(ByteInput**)view_get_model(byte_input->view) = byte_input;
+    view_set_context(byte_input->view, byte_input);
+    view_set_draw_callback(byte_input->view, byte_input_draw_callback);
+    view_set_input_callback(byte_input->view, byte_input_input_callback);
+    HarnessViewHooks hooks = {NULL, NULL, NULL, byte_input_type, byte_input};
+    view_set_harness_hooks(byte_input->view, &hooks);
+    return byte_input;
+}
+
+void byte_input_free(ByteInput* byte_input) {
+    view_free(byte_input->view);
+    free(byte_input);
+}
+
+View* byte_input_get_view(ByteInput* byte_input) {
+    return byte_input->view;
+}
+
+void byte_input_set_header_text(ByteInput* byte_input, const char* text) {
+    snprintf(byte_input->header, LABEL_SIZE, "%s", text);
+}
+
+void byte_input_set_result_callback(
+    ByteInput* byte_input,
+    ByteInputCallback input_callback,
+    ByteChangedCallback changed_callback,
+    void* callback_context,
+    uint8_t* bytes,
+    uint8_t bytes_count) {
+    byte_input->input_callback = input_callback;
+    byte_input->changed_callback = changed_callback;
+    byte_input->callback_context = callback_context;
+    byte_input->bytes = bytes;
+    byte_input->bytes_count = bytes_count;
+}
+
+// Widget: the text scroll element only, its first line is drawn
+
+struct Widget {
+    View* view;
+    char* text;
+};
+
+static void widget_draw_callback(Canvas* canvas, void* model) {
+    Widget* widget = *(Widget**)model;
+    if(widget->text == NULL) return;
+    char line[LABEL_SIZE];
+    size_t length = strcspn(widget->text, "\n");
+    snprintf(line, sizeof(line), "%.*s", (int)length, widget->text);
+    canvas_draw_str(canvas, 0, 0, line);
+}
+
+Widget* widget_alloc(void) {
+    Widget* widget = malloc(sizeof(Widget));
+    memset(widget, 0, sizeof(Widget));
+    widget->view = view_alloc();
+    view_allocate_model(widget->view, ViewModelTypeLocking, sizeof(Widget*));
+    *(Widget**)view_get_model(widget->view) = widget;
+    view_set_draw_callback(widget->view, widget_draw_callback);
+    return widget;
+}
+
+void widget_free(Widget* widget) {
+    widget_reset(widget);
+    view_free(widget->view);
+    free(widget);
+}
+
+void widget_reset(Widget* widget) {
+    free(widget->text);
+    widget->text = NULL;
+}
+
+View* widget_get_view(Widget* widget) {
+    return widget->view;
+}
+
+void widget_add_text_scroll_element(
+    Widget* widget,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height,
+    const char* text) {
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(width);
+    UNUSED(height);
+    widget_reset(widget);
+    widget->text = malloc(strlen(text) + 1);
+    strcpy(widget->text, text);
+}
+
+// Dialogs: they block on the Flipper until answered, here they take the next queued answer
+
+static char answers[ANSWERS][LABEL_SIZE];
+static size_t answer_head;
+static size_t answer_count;
+static char last_dialog[SCREEN_SIZE];
+
+void harness_answer_push(const char* answer) {
+    if(answer_count == ANSWERS) {
+        harness_fail("Too many answers queued");
+        return;
+    }
+    snprintf(answers[(answer_head + answer_count++) % ANSWERS], LABEL_SIZE, "%s", answer);
+}
+
+size_t harness_answers_pending(void) {
+    return answer_count;
+}
+
+const char* harness_last_dialog(void) {
+    return last_dialog;
+}
+
+static const char* answer_pop(const char* dialog) {
+    snprintf(last_dialog, SCREEN_SIZE, "%s", dialog);
+    if(harness_verbose()) fprintf(stderr, "    dialog: %s\n", dialog);
+    if(answer_count == 0) {
+        harness_fail("The dialog \"%s\" was shown with no answer queued", dialog);
+        return NULL;
+    }
+    const char* answer = answers[answer_head];
+    answer_head = (answer_head + 1) % ANSWERS;
+    answer_count--;
+    return answer;
+}
+
+void dialog_file_browser_set_basic_options(
+    DialogsFileBrowserOptions* options,
+    const char* extension,
+    const Icon* icon) {
+    memset(options, 0, sizeof(DialogsFileBrowserOptions));
+    options->extension = extension;
+    options->skip_assets = true;
+    options->hide_dot_files = true;
+    options->icon = icon;
+    options->hide_ext = true;
+}
+
+bool dialog_file_browser_show(
+    DialogsApp* context,
+    FuriString* result_path,
+    FuriString* path,
+    const DialogsFileBrowserOptions* options) {
+    UNUSED(context);
+    char dialog[SCREEN_SIZE];
+    snprintf(dialog, sizeof(dialog), "File browser: %s", furi_string_get_cstr(path));
+    const char* answer = answer_pop(dialog);
+    if(answer == NULL || strcmp(answer, "back") == 0) return false;
+
+    // A name is picked in the base path, like the browser shows it
+    char picked[SCREEN_SIZE];
+    snprintf(
+        picked,
+        sizeof(picked),
+        "%s%s%s",
+        answer[0] == '/' ? "" : options->base_path,
+        answer[0] == '/' ? "" : "/",
+        answer);
+    char host_path[SCREEN_SIZE];
+    struct stat info;
+    if(!harness_host_path(picked, host_path, sizeof(host_path)) ||
+       stat(host_path, &info) != 0) {
+        harness_fail("The file browser can't pick %s, it doesn't exist", picked);
+        return false;
+    }
+    furi_string_set_str(result_path, picked);
+    return true;
+}
+
+struct DialogMessage {
+    char header[LABEL_SIZE];
+    char text[SCREEN_SIZE / 2];
+    const char* buttons[3]; // Left, center, right
+};
+
+DialogMessage* dialog_message_alloc(void) {
+    DialogMessage* message = malloc(sizeof(DialogMessage));
+    memset(message, 0, sizeof(DialogMessage));
+    return message;
+}
+
+void dialog_message_free(DialogMessage* message) {
+    free(message);
+}
+
+void dialog_message_set_header(
+    DialogMessage* message,
+    const char* text,
+    uint8_t x,
+    uint8_t y,
+    Align horizontal,
+    Align vertical) {
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(horizontal);
+    UNUSED(vertical);
+    snprintf(message->header, sizeof(message->header), "%s", text);
+}
+
+void dialog_message_set_text(
+    DialogMessage* message,
+    const char* text,
+    uint8_t x,
+    uint8_t y,
+    Align horizontal,
+    Align vertical) {
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(horizontal);
+    UNUSED(vertical);
+    snprintf(message->text, sizeof(message->text), "%s", text);
+}
+
+void dialog_message_set_buttons(
+    DialogMessage* message,
+    const char* left,
+    const char* center,
+    const char* right) {
+    message->buttons[0] = left;
+    message->buttons[1] = center;
+    message->buttons[2] = right;
+}
+
+DialogMessageButton dialog_message_show(DialogsApp* context, const DialogMessage* message) {
+    UNUSED(context);
+    char dialog[SCREEN_SIZE];
+    snprintf(dialog, sizeof(dialog), "%s | %s |", message->header, message->text);
+    for(size_t i = 0; i < 3; i++) {
+        if(message->buttons[i]) {
+            size_t length = strlen(dialog);
+            snprintf(dialog + length, sizeof(dialog) - length, " [%s]", message->buttons[i]);
+        }
+    }
+    for(char* c = dialog; *c; c++) {
+        if(*c == '\n') *c = ' ';
+    }
+    const char* answer = answer_pop(dialog);
+    if(answer == NULL || strcmp(answer, "back") == 0) return DialogMessageButtonBack;
+    static const DialogMessageButton buttons[] = {
+        DialogMessageButtonLeft, DialogMessageButtonCenter, DialogMessageButtonRight};
+    for(size_t i = 0; i < 3; i++) {
+        if(message->buttons[i] && strcmp(message->buttons[i], answer) == 0) return buttons[i];
+    }
+    harness_fail("The dialog \"%s\" has no button %s", dialog, answer);
+    return DialogMessageButtonBack;
+}
@@ -0,0 +1,446 @@
+// Storage on the host, for t5577_harness: files, streams, flipper_format and the .raw reader, on
+// top of stdio. "/data" is the harness's data directory, nothing outside it can be opened.
+
+#include "t5577_harness.h"
+#include "t5577_raw_file.h"
+
+#include <flipper_format.h>
+#include <lib/lfrfid/lfrfid_raw_file.h>
+#include <toolbox/stream/file_stream.h>
+
+#include <errno.h>
+#include <sys/stat.h>
+
+#define HOST_PATH_SIZE  512
+#define FORMAT_LINE_SIZE 256
+
+static char storage_root[HOST_PATH_SIZE];
+
+void harness_storage_set_root(const char* root) {
+    snprintf(storage_root, sizeof(storage_root), "%s", root);
+}
+
+bool harness_host_path(const char* path, char* host_path, size_t size) {
+    size_t prefix = strlen(STORAGE_APP_DATA_PATH_PREFIX);
+    if(strncmp(path, STORAGE_APP_DATA_PATH_PREFIX, prefix) != 0 ||
+       (path[prefix] != '\0' && path[prefix] != '/')) {
+        return false;
+    }
+    return (size_t)snprintf(host_path, size, "%s%s", storage_root, path + prefix) < size;
+}
+
+static bool host_exists(const char* host_path) {
+    struct stat info;
+    return stat(host_path, &info) == 0;
+}
+
+// The stdio mode for a storage open, NULL if the open has to fail
+static const char*
+    storage_fopen_mode(const char* host_path, FS_AccessMode access, FS_OpenMode mode) {
+    bool exists = host_exists(host_path);
+    switch(mode) {
+    case FSOM_OPEN_EXISTING:
+        if(!exists) return NULL;
+        return access == FSAM_READ ? "rb" : "r+b";
+    case FSOM_OPEN_ALWAYS:
+        if(exists) return access == FSAM_READ ? "rb" : "r+b";
+        return "w+b";
+    case FSOM_OPEN_APPEND:
+        return "a+b";
+    case FSOM_CREATE_NEW:
+        return exists ? NULL : "w+b";
+    case FSOM_CREATE_ALWAYS:
+        return "w+b";
+    }
+    return NULL;
+}
+
+static FILE* storage_fopen(const char* path, FS_AccessMode access, FS_OpenMode mode) {
+    char host_path[HOST_PATH_SIZE];
+    if(!harness_host_path(path, host_path, sizeof(host_path))) {
+        harness_fail("%s is outside %s", path, STORAGE_APP_DATA_PATH_PREFIX);
+        return NULL;
+    }
+    const char* fopen_mode = storage_fopen_mode(host_path, access, mode);
+    return fopen_mode ? fopen(host_path, fopen_mode) : NULL;
+}
+
+static size_t storage_fsize(FILE* file) {
+    struct stat info;
+    fflush(file);
+    return fstat(fileno(file), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+// Storage
+
+struct File {
+    FILE* file;
+};
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    File* file = malloc(sizeof(File));
+    file->file = NULL;
+    return file;
+}
+
+void storage_file_free(File* file) {
+    if(file->file) harness_fail("A file was freed while it was still open");
+    storage_file_close(file);
+    free(file);
+}
+
+bool storage_file_open(File* file, const char* path, FS_AccessMode access, FS_OpenMode mode) {
+    if(file->file) harness_fail("A file was opened twice");
+    file->file = storage_fopen(path, access, mode);
+    return file->file != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(file->file == NULL) return false;
+    fclose(file->file);
+    file->file = NULL;
+    return true;
+}
+
+size_t storage_file_read(File* file, void* buffer, size_t size) {
+    return file->file ? fread(buffer, 1, size, file->file) : 0;
+}
+
+size_t storage_file_write(File* file, const void* buffer, size_t size) {
+    return file->file ? fwrite(buffer, 1, size, file->file) : 0;
+}
+
+bool storage_file_eof(File* file) {
+    return file->file == NULL || (size_t)ftell(file->file) >= storage_fsize(file->file);
+}
+
+bool storage_file_exists(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char host_path[HOST_PATH_SIZE];
+    return harness_host_path(path, host_path, sizeof(host_path)) && host_exists(host_path);
+}
+
+bool storage_simply_mkdir(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char host_path[HOST_PATH_SIZE];
+    if(!harness_host_path(path, host_path, sizeof(host_path))) return false;
+    return mkdir(host_path, 0755) == 0 || errno == EEXIST;
+}
+
+bool storage_simply_remove(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char host_path[HOST_PATH_SIZE];
+    if(!harness_host_path(path, host_path, sizeof(host_path))) return false;
+    // Like the firmware, a file that isn't there counts as removed
+    return remove(host_path) == 0 || errno == ENOENT;
+}
+
+// Streams: only file streams
+
+struct Stream {
+    FILE* file;
+};
+
+Stream* file_stream_alloc(Storage* storage) {
+    UNUSED(storage);
+    Stream* stream = malloc(sizeof(Stream));
+    stream->file = NULL;
+    return stream;
+}
+
+bool file_stream_open(Stream* stream, const char* path, FS_AccessMode access, FS_OpenMode mode) {
+    if(stream->file) harness_fail("A stream was opened twice");
+    stream->file = storage_fopen(path, access, mode);
+    return stream->file != NULL;
+}
+
+bool file_stream_close(Stream* stream) {
+    if(stream->file == NULL) return false;
+    fclose(stream->file);
+    stream->file = NULL;
+    return true;
+}
+
+void stream_free(Stream* stream) {
+    file_stream_close(stream);
+    free(stream);
+}
+
+size_t stream_read(Stream* stream, uint8_t* data, size_t size) {
+    return stream->file ? fread(data, 1, size, stream->file) : 0;
+}
+
+size_t stream_write(Stream* stream, const uint8_t* data, size_t size) {
+    return stream->file ? fwrite(data, 1, size, stream->file) : 0;
+}
+
+bool stream_read_line(Stream* stream, FuriString* line) {
+    // The line is returned with its '\n', like the firmware does
+    furi_string_reset(line);
+    if(stream->file == NULL) return false;
+    char buffer[64];
+    size_t length = 0;
+    int c;
+    while((c = fgetc(stream->file)) != EOF) {
+        buffer[length++] = (char)c;
+        if(c == '\n' || length == sizeof(buffer) - 1) {
+            buffer[length] = '\0';
+            furi_string_cat_str(line, buffer);
+            length = 0;
+            if(c == '\n') break;
+        }
+    }
+    buffer[length] = '\0';
+    furi_string_cat_str(line, buffer);
+    return !furi_string_empty(line);
+}
+
+bool stream_rewind(Stream* stream) {
+    return stream->file && fseek(stream->file, 0, SEEK_SET) == 0;
+}
+
+bool stream_seek(Stream* stream, int32_t offset, StreamOffset offset_type) {
+    if(stream->file == NULL) return false;
+    int64_t size = (int64_t)storage_fsize(stream->file);
+    int64_t position = offset;
+    if(offset_type == StreamOffsetFromCurrent) position += ftell(stream->file);
+    if(offset_type == StreamOffsetFromEnd) position += size;
+    // The firmware's file stream stops at either end and reports it
+    bool inside = position >= 0 && position <= size;
+    position = position < 0 ? 0 : (position > size ? size : position);
+    fseek(stream->file, (long)position, SEEK_SET);
+    return inside;
+}
+
+size_t stream_tell(Stream* stream) {
+    return stream->file ? (size_t)ftell(stream->file) : 0;
+}
+
+size_t stream_size(Stream* stream) {
+    return stream->file ? storage_fsize(stream->file) : 0;
+}
+
+// Flipper format: "Key: value" lines. A read looks for the key from the current position on, and
+// leaves the position after the line it read, or at the end of the file if the key isn't there.
+
+struct FlipperFormat {
+    FILE* file;
+};
+
+FlipperFormat* flipper_format_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    FlipperFormat* flipper_format = malloc(sizeof(FlipperFormat));
+    flipper_format->file = NULL;
+    return flipper_format;
+}
+
+void flipper_format_free(FlipperFormat* flipper_format) {
+    if(flipper_format->file) fclose(flipper_format->file);
+    free(flipper_format);
+}
+
+bool flipper_format_file_open_existing(FlipperFormat* flipper_format, const char* path) {
+    flipper_format->file = storage_fopen(path, FSAM_READ_WRITE, FSOM_OPEN_EXISTING);
+    return flipper_format->file != NULL;
+}
+
+bool flipper_format_file_open_always(FlipperFormat* flipper_format, const char* path) {
+    flipper_format->file = storage_fopen(path, FSAM_READ_WRITE, FSOM_CREATE_ALWAYS);
+    return flipper_format->file != NULL;
+}
+
+bool flipper_format_rewind(FlipperFormat* flipper_format) {
+    return flipper_format->file && fseek(flipper_format->file, 0, SEEK_SET) == 0;
+}
+
+static bool flipper_format_write_line(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const char* value) {
+    if(flipper_format->file == NULL) return false;
+    return fprintf(flipper_format->file, "%s: %s\n", key, value) > 0;
+}
+
+// The value of the next line with this key, NULL if there is none
+static const char*
+    flipper_format_find(FlipperFormat* flipper_format, const char* key, char* line) {
+    if(flipper_format->file == NULL) return NULL;
+    size_t key_length = strlen(key);
+    while(fgets(line, FORMAT_LINE_SIZE, flipper_format->file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if(strncmp(line, key, key_length) == 0 && line[key_length] == ':') {
+            const char* value = line + key_length + 1;
+            return value[0] == ' ' ? value + 1 : value;
+        }
+    }
+    return NULL;
+}
+
+bool flipper_format_write_header_cstr(
+    FlipperFormat* flipper_format,
+    const char* filetype,
+    const uint32_t version) {
+    char value[16];
+    snprintf(value, sizeof(value), "%lu", (unsigned long)version);
+    return flipper_format_write_line(flipper_format, "Filetype", filetype) &&
+           flipper_format_write_line(flipper_format, "Version", value);
+}
+
+bool flipper_format_write_string_cstr(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const char* data) {
+    return flipper_format_write_line(flipper_format, key, data);
+}
+
+bool flipper_format_write_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint32_t* data,
+    const uint16_t data_size) {
+    char value[FORMAT_LINE_SIZE] = "";
+    for(uint16_t i = 0; i < data_size; i++) {
+        size_t length = strlen(value);
+        snprintf(
+            value + length,
+            sizeof(value) - length,
+            "%s%lu",
+            i ? " " : "",
+            (unsigned long)data[i]);
+    }
+    return flipper_format_write_line(flipper_format, key, value);
+}
+
+bool flipper_format_read_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint32_t* data,
+    const uint16_t data_size) {
+    char line[FORMAT_LINE_SIZE];
+    const char* value = flipper_format_find(flipper_format, key, line);
+    if(value == NULL) return false;
+    for(uint16_t i = 0; i < data_size; i++) {
+        char* end;
+        unsigned long number = strtoul(value, &end, 10);
+        if(end == value) return false;
+        data[i] = (uint32_t)number;
+        value = end;
+    }
+    return true;
+}
+
+bool flipper_format_write_bool(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const bool* data,
+    const uint16_t data_size) {
+    char value[FORMAT_LINE_SIZE] = "";
+    for(uint16_t i = 0; i < data_size; i++) {
+        size_t length = strlen(value);
+        snprintf(
+            value + length,
+            sizeof(value) - length,
+            "%s%s",
+            i ? " " : "",
+            data[i] ? "true" : "false");
+    }
+    return flipper_format_write_line(flipper_format, key, value);
+}
+
+bool flipper_format_read_bool(
+    FlipperFormat* flipper_format,
+    const char* key,
+    bool* data,
+    const uint16_t data_size) {
+    char line[FORMAT_LINE_SIZE];
+    const char* value = flipper_format_find(flipper_format, key, line);
+    if(value == NULL) return false;
+    for(uint16_t i = 0; i < data_size; i++) {
+        while(*value == ' ') value++;
+        if(strncmp(value, "true", 4) == 0) {
+            data[i] = true;
+            value += 4;
+        } else if(strncmp(value, "false", 5) == 0) {
+            data[i] = false;
+            value += 5;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool flipper_format_write_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint8_t* data,
+    const uint16_t data_size) {
+    char value[FORMAT_LINE_SIZE] = "";
+    for(uint16_t i = 0; i < data_size && 3 * (size_t)i + 3 < sizeof(value); i++) {
+        size_t length = strlen(value);
+        snprintf(value + length, sizeof(value) - length, "%s%02X", i ? " " : "", data[i]);
+    }
+    return flipper_format_write_line(flipper_format, key, value);
+}
+
+bool flipper_format_read_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint8_t* data,
+    const uint16_t data_size) {
+    char line[FORMAT_LINE_SIZE];
+    const char* value = flipper_format_find(flipper_format, key, line);
+    if(value == NULL) return false;
+    for(uint16_t i = 0; i < data_size; i++) {
+        while(*value == ' ') value++;
+        char* end;
+        char pair[3] = {value[0], value[0] ? value[1] : '\0', '\0'};
+        unsigned long byte = strtoul(pair, &end, 16);
+        if(end != pair + 2) return false;
+        data[i] = (uint8_t)byte;
+        value += 2;
+    }
+    return true;
+}
+
+// The .raw reader, see t5577_raw_file.h for the format
+
+struct LFRFIDRawFile {
+    RawFile raw;
+};
+
+LFRFIDRawFile* lfrfid_raw_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    LFRFIDRawFile* file = malloc(sizeof(LFRFIDRawFile));
+    memset(file, 0, sizeof(LFRFIDRawFile));
+    return file;
+}
+
+void lfrfid_raw_file_free(LFRFIDRawFile* file) {
+    raw_file_close(&file->raw);
+    free(file);
+}
+
+bool lfrfid_raw_file_open_read(LFRFIDRawFile* file, const char* file_path) {
+    char host_path[HOST_PATH_SIZE];
+    raw_file_close(&file->raw);
+    if(!harness_host_path(file_path, host_path, sizeof(host_path))) return false;
+    return raw_file_open_read(&file->raw, host_path);
+}
+
+bool lfrfid_raw_file_read_header(LFRFIDRawFile* file, float* frequency, float* duty_cycle) {
+    if(file->raw.file == NULL) return false;
+    *frequency = file->raw.header.frequency;
+    *duty_cycle = file->raw.header.duty_cycle;
+    return true;
+}
+
+bool lfrfid_raw_file_read_pair(
+    LFRFIDRawFile* file,
+    uint32_t* duration,
+    uint32_t* pulse,
+    bool* pass_end) {
+    if(file->raw.buffer == NULL) return false;
+    return raw_file_read_pair(&file->raw, duration, pulse, pass_end);
+}
@@ -0,0 +1,276 @@
+// The tag in front of the antenna, for t5577_harness. The RFID timer calls of the write path are
+// decoded the way a T5577 does: the field is on between two gaps for a short time for a 0 and a
+// longer one for a 1, and anything longer ends the frame. Complete block writes then change the
+// tag, within the rules of its password and lock bits. The raw read records the tag's reply, made
+// up with t5577_capture_synth from the modulation and RF clock in its block 0.
+
+#include "t5577_harness.h"
+#include "t5577_capture_synth.h"
+#include "t5577_raw_file.h"
+
+#include <furi_hal.h>
+#include <lib/lfrfid/protocols/lfrfid_protocols.h>
+#include <t5577_config.h>
+#include <t5577_plan.h>
+
+#define TAG_LOG "Tag"
+
+#define TAG_PAGE_1_BLOCKS  T5577_PLAN_PAGE_1_BLOCK_COUNT
+#define TAG_BIT_MIN_CYCLES 8 // Shorter and the two gaps are one to the tag
+#define TAG_BIT_1_CYCLES   40 // DATA_0 is 24 cycles, DATA_1 56
+#define TAG_BIT_MAX_CYCLES 80 // Longer and it is the wait before or after a frame
+#define TAG_WRITE_BITS     38 // opcode 2 + lock 1 + data 32 + address 3
+#define TAG_PASS_BITS      70 // The same with a 32 bit password after the opcode
+#define TAG_MODULATION     0x0001F000 // Block 0 bits that select the modulation
+#define TAG_DEFAULT_BLOCK_0 \
+    (LFRFID_T5577_MODULATION_MANCHESTER | LFRFID_T5577_BITRATE_RF_64 | \
+     (2 << LFRFID_T5577_MAXBLOCK_SHIFT))
+
+typedef struct {
+    bool present;
+    uint32_t page_0[LFRFID_T5577_BLOCK_COUNT];
+    uint32_t page_1[TAG_PAGE_1_BLOCKS];
+    bool locked_0[LFRFID_T5577_BLOCK_COUNT];
+    bool locked_1[TAG_PAGE_1_BLOCKS];
+    uint32_t writes;
+    uint32_t replies; // Seeds the reply data, so every run is the same
+
+    // The downlink being decoded
+    bool field;
+    uint64_t field_on_us; // When the field came back after the last gap
+    uint8_t frame[T5577_PLAN_MAX_BITS + 1];
+    uint8_t frame_bits;
+} Tag;
+
+static Tag tag;
+
+void harness_tag_reset(void) {
+    memset(&tag, 0, sizeof(Tag));
+    tag.present = true;
+    tag.page_0[0] = TAG_DEFAULT_BLOCK_0;
+}
+
+void harness_tag_set_present(bool present) {
+    tag.present = present;
+}
+
+static uint32_t* tag_block(uint8_t page, uint8_t block, bool** locked) {
+    if(page == 0 && block < LFRFID_T5577_BLOCK_COUNT) {
+        if(locked) *locked = &tag.locked_0[block];
+        return &tag.page_0[block];
+    }
+    if(page == 1 && block == 0) return tag_block(0, 0, locked); // The same block
+    if(page == 1 && block < TAG_PAGE_1_BLOCKS) {
+        if(locked) *locked = &tag.locked_1[block];
+        return &tag.page_1[block];
+    }
+    return NULL;
+}
+
+void harness_tag_set_block(uint8_t page, uint8_t block, uint32_t data) {
+    uint32_t* target = tag_block(page, block, NULL);
+    if(target) *target = data;
+}
+
+uint32_t harness_tag_block(uint8_t page, uint8_t block) {
+    uint32_t* target = tag_block(page, block, NULL);
+    return target ? *target : 0;
+}
+
+bool harness_tag_locked(uint8_t page, uint8_t block) {
+    bool* locked = NULL;
+    tag_block(page, block, &locked);
+    return locked && *locked;
+}
+
+uint32_t harness_tag_writes(void) {
+    return tag.writes;
+}
+
+static uint32_t tag_frame_bits(uint8_t first, uint8_t count) {
+    uint32_t value = 0;
+    for(uint8_t i = 0; i < count; i++) {
+        value = (value << 1) | tag.frame[first + i];
+    }
+    return value;
+}
+
+// A frame the field brought in full. Only block writes are acted on: a reset or a frame that was
+// cut short leaves the tag as it was.
+static void tag_frame_end(void) {
+    uint8_t bits = tag.frame_bits;
+    tag.frame_bits = 0;
+    if(!tag.present || (bits != TAG_WRITE_BITS && bits != TAG_PASS_BITS)) return;
+    if(tag.frame[0] != 1) return; // Opcode 1p is a write to page p
+    uint8_t page = tag.frame[1];
+    bool with_pass = bits == TAG_PASS_BITS;
+    uint8_t next = 2;
+    uint32_t password = 0;
+    if(with_pass) {
+        password = tag_frame_bits(next, 32);
+        next += 32;
+    }
+    bool lock = tag.frame[next++];
+    uint32_t data = tag_frame_bits(next, 32);
+    uint8_t address = (uint8_t)tag_frame_bits(next + 32, 3);
+
+    // With the password bit set, only a write that sends block 7 gets in
+    if(tag.page_0[0] & LFRFID_T5577_PWD) {
+        if(!with_pass || password != tag.page_0[T5577_PLAN_PASSWORD_BLOCK]) return;
+    }
+    bool* locked = NULL;
+    uint32_t* target = tag_block(page, address, &locked);
+    if(target == NULL || (locked && *locked)) return;
+    *target = data;
+    if(lock && locked) *locked = true;
+    tag.writes++;
+    FURI_LOG_D(
+        TAG_LOG,
+        "Wrote page %u block %u: %08lX%s",
+        page,
+        address,
+        (unsigned long)data,
+        lock ? " locked" : "");
+}
+
+void furi_hal_rfid_tim_read_start(float frequency, float duty_cycle) {
+    UNUSED(frequency);
+    UNUSED(duty_cycle);
+    tag.field = true;
+    tag.field_on_us = harness_now_us();
+    tag.frame_bits = 0;
+}
+
+void furi_hal_rfid_tim_read_stop(void) {
+    if(tag.field) tag_frame_end();
+    tag.field = false;
+}
+
+void furi_hal_rfid_tim_read_pause(void) {
+    if(!tag.field) return;
+    uint64_t cycles = (harness_now_us() - tag.field_on_us) / T5577_PLAN_RF_CYCLE_US;
+    if(cycles < TAG_BIT_MIN_CYCLES) return;
+    if(cycles >= TAG_BIT_MAX_CYCLES) {
+        tag_frame_end();
+        return;
+    }
+    if(tag.frame_bits < sizeof(tag.frame)) {
+        tag.frame[tag.frame_bits++] = cycles >= TAG_BIT_1_CYCLES;
+    }
+}
+
+void furi_hal_rfid_tim_read_continue(void) {
+    if(tag.field) tag.field_on_us = harness_now_us();
+}
+
+void furi_hal_rfid_pin_pull_release(void) {
+}
+
+void furi_hal_rfid_pins_reset(void) {
+}
+
+// The firmware's write functions, sent through the same write path as the plans
+
+static void tag_write(LFRFIDT5577* data, bool with_pass, uint32_t password) {
+    T5577Plan plan;
+    t5577_plan_clear(&plan);
+    for(uint32_t i = 0; i < data->blocks_to_write && i < LFRFID_T5577_BLOCK_COUNT; i++) {
+        t5577_plan_add_block(&plan, 0, (uint8_t)i, data->block[i], false, with_pass, password);
+    }
+    t5577_plan_write(&plan, false);
+}
+
+void t5577_write(LFRFIDT5577* data) {
+    tag_write(data, false, 0);
+}
+
+void t5577_write_with_pass(LFRFIDT5577* data, uint32_t password) {
+    tag_write(data, true, password);
+}
+
+// Raw read. The reply is recorded the moment it starts: nothing changes the tag while it runs.
+
+struct ProtocolDict {
+    size_t protocol_count;
+};
+
+const ProtocolBase* lfrfid_protocols[] = {NULL};
+
+ProtocolDict* protocol_dict_alloc(const ProtocolBase** protocols, size_t protocol_count) {
+    UNUSED(protocols);
+    ProtocolDict* dict = malloc(sizeof(ProtocolDict));
+    dict->protocol_count = protocol_count;
+    return dict;
+}
+
+void protocol_dict_free(ProtocolDict* dict) {
+    free(dict);
+}
+
+struct LFRFIDWorker {
+    ProtocolDict* dict;
+    bool thread;
+    bool reading;
+};
+
+LFRFIDWorker* lfrfid_worker_alloc(ProtocolDict* dict) {
+    LFRFIDWorker* worker = malloc(sizeof(LFRFIDWorker));
+    memset(worker, 0, sizeof(LFRFIDWorker));
+    worker->dict = dict;
+    return worker;
+}
+
+void lfrfid_worker_free(LFRFIDWorker* worker) {
+    if(worker->thread) harness_fail("The LF RFID worker was freed with its thread running");
+    free(worker);
+}
+
+void lfrfid_worker_start_thread(LFRFIDWorker* worker) {
+    worker->thread = true;
+}
+
+void lfrfid_worker_stop_thread(LFRFIDWorker* worker) {
+    if(worker->reading) harness_fail("The LF RFID worker thread was stopped while reading");
+    worker->thread = false;
+}
+
+void lfrfid_worker_stop(LFRFIDWorker* worker) {
+    worker->reading = false;
+}
+
+// The RF clock of a block 0, 0 if it isn't one of all_rf_clocks
+static uint32_t tag_rf_clock(uint32_t block_zero) {
+    for(uint8_t i = 0; i < CLOCK_NUM; i++) {
+        if(all_rf_clocks[i].clock_page_zero == (block_zero & LFRFID_T5577_BITRATE_RF_128)) {
+            return all_rf_clocks[i].rf_clock_num;
+        }
+    }
+    return 0;
+}
+
+void lfrfid_worker_read_raw_start(
+    LFRFIDWorker* worker,
+    const char* filename,
+    LFRFIDWorkerReadType type,
+    LFRFIDWorkerReadRawCallback callback,
+    void* context) {
+    if(!worker->thread) harness_fail("The LF RFID worker read without its thread");
+    worker->reading = true;
+    char host_path[512];
+    bool written = false;
+    if(harness_host_path(filename, host_path, sizeof(host_path))) {
+        // PSK excitation isn't modelled, the tag doesn't answer it
+        uint32_t rf_clock = tag_rf_clock(tag.page_0[0]);
+        bool reply = tag.present && type != LFRFIDWorkerReadTypePSKOnly && rf_clock;
+        float frequency = type == LFRFIDWorkerReadTypePSKOnly ? 62500.0f : 125000.0f;
+        // The synthetic envelope isn't the app's memory, it only stands in for the antenna
+        harness_heap_pause(true);
+        Capture capture;
+        capture_init(&capture, frequency, 1, ++tag.replies);
+        if(reply) capture_generate(&capture, tag.page_0[0] & TAG_MODULATION, rf_clock);
+        written = raw_file_write(host_path, frequency, reply ? &capture : NULL);
+        capture_free(&capture);
+        harness_heap_pause(false);
+    }
+    if(!written && callback) callback(LFRFIDWorkerReadRawFileError, context);
+}
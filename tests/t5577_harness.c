@@ -0,0 +1,657 @@
+// Runs the whole app on the host, from t5577_writer_app_alloc to its free, against the fake SDK in
+// t5577_fake_*.c, and plays a script of user input and checks against it. Every key press, timer,
+// CLI command and launch is timed until the app is idle again, in host time and in device time,
+// and reported per transition between views along with the time each view takes to draw.
+//
+// t5577_harness [--root DIR] [--verbose] SCRIPT
+//
+// The data directory is a new temporary one, removed at the end, unless --root is given. A script
+// has one command per line, '#' starts a comment:
+//
+//   launch                       start the app, the next lines run while it is open
+//   press KEY [N]                up, down, left, right, ok or back, N times
+//   select LABEL                 move to the submenu or config item and press OK
+//   set LABEL = VALUE            move to the config item and change it until it shows VALUE
+//   type TEXT                    enter TEXT in the text or byte input and confirm it
+//   answer ANSWER                queue the answer to the next dialog: a button, a file or "back"
+//   wait MS                      let MS of device time pass, firing the timers that are due
+//   cli LINE                     run a CLI command, like "t5577 write 00148040"
+//   tag on|off|reset             put the tag in front of the antenna, take it away, or a new one
+//   tag block PAGE BLOCK HEX     set a block of the tag
+//   file NAME ... end            write the lines in between to NAME in the data directory
+//   expect view NAME             the current view, "none" when the app isn't showing one
+//   expect screen TEXT           the last frame drew TEXT
+//   expect value LABEL = TEXT    the config item shows TEXT
+//   expect dialog TEXT           the last dialog showed TEXT
+//   expect log TEXT              the app logged TEXT since the last command
+//   expect notification NAME     the app sent this notification since the last command
+//   expect cli TEXT              the last CLI command replied TEXT
+//   expect tag block P B HEX     the tag holds HEX in that block
+//   expect tag locked P B        the block is locked
+//   expect file NAME [contains TEXT|missing]
+//   expect heap below BYTES      the peak heap of the app, since it was launched, is below BYTES
+
+#define _DEFAULT_SOURCE
+
+#include "t5577_harness.h"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SCRIPT_LINES     512
+#define SCRIPT_LINE_SIZE 256
+#define TRANSITIONS      128
+#define REDRAW_VIEWS     16
+#define REPLY_SIZE       256
+#define HOST_PATH_SIZE   512
+#define NAVIGATE_LIMIT   32 // Key presses to reach an item before giving up
+
+int32_t main_t5577_writer_app(void* p);
+
+// T5577WriterView in t5577_writer.c, in the same order
+static const char* const view_names[] = {
+    "Submenu",
+    "TextInput",
+    "ByteInput",
+    "Load",
+    "Save",
+    "Configure_i",
+    "Configure_e",
+    "Write",
+    "Recover",
+    "Capture",
+    "About",
+};
+
+const char* harness_view_name(uint32_t view_id) {
+    if(view_id == VIEW_NONE) return "none";
+    if(view_id < COUNT_OF(view_names)) return view_names[view_id];
+    return "?";
+}
+
+static char script[SCRIPT_LINES][SCRIPT_LINE_SIZE];
+static size_t script_count;
+static size_t script_next; // The line harness_step runs next
+static size_t script_line; // The line running now, from 1, for messages
+static const char* script_path;
+
+static bool verbose;
+static size_t failures;
+
+bool harness_verbose(void) {
+    return verbose;
+}
+
+void harness_fail(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    printf("%s:%zu: ", script_path, script_line);
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+    failures++;
+}
+
+static uint64_t real_us(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
+// Latency
+
+typedef struct {
+    uint64_t count;
+    uint64_t real_total_us;
+    uint64_t real_max_us;
+    uint64_t device_total_us;
+    uint64_t device_max_us;
+} Latency;
+
+static void latency_add(Latency* latency, uint64_t real_us, uint64_t device_us) {
+    latency->count++;
+    latency->real_total_us += real_us;
+    latency->device_total_us += device_us;
+    if(real_us > latency->real_max_us) latency->real_max_us = real_us;
+    if(device_us > latency->device_max_us) latency->device_max_us = device_us;
+}
+
+typedef struct {
+    char kind[16]; // What started it: "ok", "timer", "cli", ...
+    uint32_t from;
+    uint32_t to;
+    Latency latency;
+} Transition;
+
+static Transition transitions[TRANSITIONS];
+static size_t transition_count;
+static Latency redraws[REDRAW_VIEWS];
+
+// The stimulus being handled: from when it happened until the app is idle again
+static struct {
+    bool active;
+    char kind[16];
+    uint32_t from;
+    uint64_t real_start_us;
+    uint64_t device_start_us;
+} stimulus;
+
+static void stimulus_begin(const char* kind) {
+    stimulus.active = true;
+    snprintf(stimulus.kind, sizeof(stimulus.kind), "%s", kind);
+    stimulus.from = harness_gui_current();
+    stimulus.real_start_us = real_us();
+    stimulus.device_start_us = harness_now_us();
+}
+
+static void stimulus_end(void) {
+    if(!stimulus.active) return;
+    stimulus.active = false;
+    uint64_t elapsed_us = real_us() - stimulus.real_start_us;
+    uint64_t elapsed_device_us = harness_now_us() - stimulus.device_start_us;
+    uint32_t to = harness_gui_running() ? harness_gui_current() : VIEW_NONE;
+    Transition* transition = NULL;
+    for(size_t i = 0; i < transition_count && transition == NULL; i++) {
+        if(strcmp(transitions[i].kind, stimulus.kind) == 0 &&
+           transitions[i].from == stimulus.from && transitions[i].to == to) {
+            transition = &transitions[i];
+        }
+    }
+    if(transition == NULL && transition_count < TRANSITIONS) {
+        transition = &transitions[transition_count++];
+        memset(transition, 0, sizeof(Transition));
+        snprintf(transition->kind, sizeof(transition->kind), "%s", stimulus.kind);
+        transition->from = stimulus.from;
+        transition->to = to;
+    }
+    if(transition) latency_add(&transition->latency, elapsed_us, elapsed_device_us);
+    if(verbose) {
+        fprintf(
+            stderr,
+            "  %-6s %s -> %s: %llu us, %llu us on the device\n",
+            stimulus.kind,
+            harness_view_name(stimulus.from),
+            harness_view_name(to),
+            (unsigned long long)elapsed_us,
+            (unsigned long long)elapsed_device_us);
+    }
+}
+
+void harness_frame(uint32_t view_id, uint64_t real_us, uint64_t device_us) {
+    if(view_id < REDRAW_VIEWS) latency_add(&redraws[view_id], real_us, device_us);
+}
+
+// Heap, per launch
+
+static struct {
+    size_t baseline; // In use before the launch
+    size_t first_frame; // Above the baseline once the app was idle for the first time
+    size_t peak; // Above the baseline, the highest of any launch
+    bool first_frame_taken;
+} heap;
+
+// Keys, in InputKey order
+
+static const struct {
+    const char* name;
+    InputKey key;
+} keys[] = {
+    {"up", InputKeyUp},
+    {"down", InputKeyDown},
+    {"right", InputKeyRight},
+    {"left", InputKeyLeft},
+    {"ok", InputKeyOk},
+    {"back", InputKeyBack},
+};
+
+static void press(InputKey key) {
+    stimulus_begin(keys[key].name);
+    harness_gui_input(key);
+    harness_gui_process();
+    stimulus_end();
+}
+
+// Moves the cursor of the current view to the item with this label. Returns its index, -1 if
+// there is no such item.
+static int32_t navigate(const char* label) {
+    const HarnessViewHooks* hooks = harness_gui_hooks();
+    if(hooks == NULL || hooks->find == NULL) {
+        harness_fail("%s has no items", harness_view_name(harness_gui_current()));
+        return -1;
+    }
+    int32_t index = hooks->find(hooks->module, label);
+    if(index < 0) {
+        harness_fail("%s has no item %s", harness_view_name(harness_gui_current()), label);
+        return -1;
+    }
+    for(size_t i = 0; i < NAVIGATE_LIMIT && hooks->cursor(hooks->module) != index; i++) {
+        press(InputKeyDown);
+    }
+    if(hooks->cursor(hooks->module) != index) {
+        harness_fail("Couldn't move to %s", label);
+        return -1;
+    }
+    return index;
+}
+
+// Presses key until the item shows value or stops changing. Returns true if it shows value.
+static bool
+    set_towards(const HarnessViewHooks* hooks, int32_t index, InputKey key, const char* value) {
+    char shown[SCRIPT_LINE_SIZE];
+    for(size_t i = 0; i < NAVIGATE_LIMIT; i++) {
+        if(strcmp(hooks->value(hooks->module, index), value) == 0) return true;
+        snprintf(shown, sizeof(shown), "%s", hooks->value(hooks->module, index));
+        press(key);
+        if(strcmp(hooks->value(hooks->module, index), shown) == 0) break;
+    }
+    return strcmp(hooks->value(hooks->module, index), value) == 0;
+}
+
+static void set(const char* label, const char* value) {
+    int32_t index = navigate(label);
+    if(index < 0) return;
+    const HarnessViewHooks* hooks = harness_gui_hooks();
+    if(hooks->value == NULL || hooks->value(hooks->module, index) == NULL) {
+        harness_fail("%s has no value", label);
+        return;
+    }
+    if(!set_towards(hooks, index, InputKeyRight, value) &&
+       !set_towards(hooks, index, InputKeyLeft, value)) {
+        harness_fail("%s can't be set to %s", label, value);
+    }
+}
+
+// Checks
+
+static char cli_reply[REPLY_SIZE];
+
+static void expect_text(const char* what, const char* text, const char* expected) {
+    if(strstr(text, expected) == NULL) {
+        harness_fail("Expected %s \"%s\", got \"%s\"", what, expected, text);
+    }
+}
+
+static bool read_host_file(const char* name, char* data, size_t size) {
+    char path[HOST_PATH_SIZE];
+    char host_path[HOST_PATH_SIZE];
+    snprintf(path, sizeof(path), "%s/%s", STORAGE_APP_DATA_PATH_PREFIX, name);
+    if(!harness_host_path(path, host_path, sizeof(host_path))) return false;
+    FILE* file = fopen(host_path, "rb");
+    if(file == NULL) return false;
+    size_t length = fread(data, 1, size - 1, file);
+    data[length] = '\0';
+    fclose(file);
+    return true;
+}
+
+static void expect_tag(char* args) {
+    unsigned page, block;
+    unsigned long data;
+    if(sscanf(args, "block %u %u %lx", &page, &block, &data) == 3) {
+        uint32_t held = harness_tag_block(page, block);
+        if(held != data) {
+            harness_fail(
+                "Expected page %u block %u to hold %08lX, it holds %08lX",
+                page,
+                block,
+                data,
+                (unsigned long)held);
+        }
+    } else if(sscanf(args, "locked %u %u", &page, &block) == 2) {
+        if(!harness_tag_locked(page, block)) {
+            harness_fail("Expected page %u block %u to be locked", page, block);
+        }
+    } else {
+        harness_fail("Bad check: expect tag %s", args);
+    }
+}
+
+static void expect_file(char* args) {
+    static char data[16 * 1024];
+    char* name = strtok(args, " ");
+    char* check = strtok(NULL, " ");
+    char* text = strtok(NULL, "");
+    if(name == NULL) {
+        harness_fail("Bad check: expect file");
+        return;
+    }
+    bool found = read_host_file(name, data, sizeof(data));
+    if(check && strcmp(check, "missing") == 0) {
+        if(found) harness_fail("Expected %s to be missing", name);
+    } else if(!found) {
+        harness_fail("Expected %s to exist", name);
+    } else if(check && strcmp(check, "contains") == 0 && text) {
+        if(strstr(data, text) == NULL) harness_fail("Expected %s to contain \"%s\"", name, text);
+    } else if(check) {
+        harness_fail("Bad check: expect file %s %s", name, check);
+    }
+}
+
+static void expect(char* line) {
+    char* what = strtok(line, " ");
+    char* args = strtok(NULL, "");
+    if(what == NULL || args == NULL) {
+        harness_fail("Bad check");
+    } else if(strcmp(what, "view") == 0) {
+        const char* name =
+            harness_view_name(harness_gui_running() ? harness_gui_current() : VIEW_NONE);
+        if(strcmp(name, args) != 0) harness_fail("Expected view %s, got %s", args, name);
+    } else if(strcmp(what, "screen") == 0) {
+        expect_text("screen", harness_gui_screen(), args);
+    } else if(strcmp(what, "value") == 0) {
+        char* equals = strstr(args, " = ");
+        const HarnessViewHooks* hooks = harness_gui_hooks();
+        if(equals == NULL || hooks == NULL || hooks->value == NULL) {
+            harness_fail("Bad check: expect value %s", args);
+            return;
+        }
+        *equals = '\0';
+        int32_t index = hooks->find(hooks->module, args);
+        const char* value = index >= 0 ? hooks->value(hooks->module, index) : NULL;
+        if(value == NULL || strcmp(value, equals + 3) != 0) {
+            harness_fail(
+                "Expected %s to show %s, got %s", args, equals + 3, value ? value : "nothing");
+        }
+    } else if(strcmp(what, "dialog") == 0) {
+        expect_text("dialog", harness_last_dialog(), args);
+    } else if(strcmp(what, "log") == 0) {
+        if(!harness_log_contains(args)) harness_fail("Expected the log to have \"%s\"", args);
+    } else if(strcmp(what, "notification") == 0) {
+        if(!harness_notification_seen(args)) harness_fail("Expected notification %s", args);
+    } else if(strcmp(what, "cli") == 0) {
+        expect_text("CLI reply", cli_reply, args);
+    } else if(strcmp(what, "tag") == 0) {
+        expect_tag(args);
+    } else if(strcmp(what, "file") == 0) {
+        expect_file(args);
+    } else if(strcmp(what, "heap") == 0) {
+        unsigned long limit;
+        if(sscanf(args, "below %lu", &limit) != 1) {
+            harness_fail("Bad check: expect heap %s", args);
+            return;
+        }
+        size_t peak = heap.peak;
+        if(harness_gui_running() && harness_heap_peak() - heap.baseline > peak) {
+            peak = harness_heap_peak() - heap.baseline;
+        }
+        if(peak >= limit) {
+            harness_fail("Expected the heap to stay below %lu bytes, it reached %zu", limit, peak);
+        }
+    } else {
+        harness_fail("Bad check: expect %s", what);
+    }
+}
+
+// Commands
+
+static void wait(uint32_t milliseconds) {
+    uint64_t until_us = harness_now_us() + (uint64_t)milliseconds * 1000;
+    while(harness_gui_running()) {
+        uint32_t from = harness_gui_current();
+        uint64_t real_start_us = real_us();
+        if(!harness_timer_fire_next(until_us)) break;
+        // Timed from when the timer was due, which the time was moved to
+        stimulus_begin("timer");
+        stimulus.from = from;
+        stimulus.real_start_us = real_start_us;
+        harness_gui_process();
+        stimulus_end();
+    }
+    if(harness_now_us() < until_us) harness_advance_us(until_us - harness_now_us());
+}
+
+static void write_file(const char* name) {
+    char path[HOST_PATH_SIZE];
+    char host_path[HOST_PATH_SIZE];
+    snprintf(path, sizeof(path), "%s/%s", STORAGE_APP_DATA_PATH_PREFIX, name);
+    FILE* file = NULL;
+    if(harness_host_path(path, host_path, sizeof(host_path))) file = fopen(host_path, "wb");
+    if(file == NULL) harness_fail("Can't write %s", name);
+    while(script_next < script_count && strcmp(script[script_next], "end") != 0) {
+        if(file) fprintf(file, "%s\n", script[script_next]);
+        script_next++;
+    }
+    if(script_next == script_count) harness_fail("file %s has no end", name);
+    script_next++;
+    if(file) fclose(file);
+}
+
+static void tag_command(char* args) {
+    unsigned page, block;
+    unsigned long data;
+    if(strcmp(args, "on") == 0) {
+        harness_tag_set_present(true);
+    } else if(strcmp(args, "off") == 0) {
+        harness_tag_set_present(false);
+    } else if(strcmp(args, "reset") == 0) {
+        harness_tag_reset();
+    } else if(sscanf(args, "block %u %u %lx", &page, &block, &data) == 3) {
+        harness_tag_set_block(page, block, data);
+    } else {
+        harness_fail("Bad command: tag %s", args);
+    }
+}
+
+static void launch(void) {
+    if(harness_gui_running()) {
+        harness_fail("The app is already open");
+        return;
+    }
+    heap.baseline = harness_heap_in_use();
+    heap.first_frame_taken = false;
+    harness_heap_reset_peak();
+    stimulus_begin("launch");
+    main_t5577_writer_app(NULL);
+    // Closing the app is timed from the step that stopped it until the app returned
+    stimulus_end();
+
+    size_t peak = harness_heap_peak() - heap.baseline;
+    if(peak > heap.peak) heap.peak = peak;
+    if(harness_heap_in_use() != heap.baseline) {
+        harness_fail("The app leaked %zd bytes", (ssize_t)(harness_heap_in_use() - heap.baseline));
+    }
+    const char* record = harness_record_open_name();
+    if(record) harness_fail("The app left the record %s open", record);
+    if(harness_timers_running()) harness_fail("The app left a timer running");
+}
+
+static void run(char* line) {
+    char* command = strtok(line, " ");
+    char* args = strtok(NULL, "");
+    if(command == NULL) return;
+    if(strcmp(command, "expect") == 0) {
+        expect(args ? args : "");
+        return;
+    }
+    // A check sees what the commands since the last one logged and notified
+    harness_log_clear();
+    harness_notification_clear();
+    if(strcmp(command, "launch") == 0) {
+        launch();
+    } else if(strcmp(command, "press") == 0) {
+        char* name = args ? strtok(args, " ") : NULL;
+        char* count_text = name ? strtok(NULL, " ") : NULL;
+        int count = count_text ? atoi(count_text) : 1;
+        size_t k = 0;
+        while(name && k < COUNT_OF(keys) && strcmp(keys[k].name, name) != 0) k++;
+        if(name == NULL || k == COUNT_OF(keys) || count < 1) {
+            harness_fail("Bad command: press %s", name ? name : "");
+            return;
+        }
+        for(int i = 0; i < count && harness_gui_running(); i++) press(keys[k].key);
+    } else if(strcmp(command, "select") == 0 && args) {
+        if(navigate(args) >= 0) press(InputKeyOk);
+    } else if(strcmp(command, "set") == 0 && args && strstr(args, " = ")) {
+        char* equals = strstr(args, " = ");
+        *equals = '\0';
+        set(args, equals + 3);
+    } else if(strcmp(command, "type") == 0 && args) {
+        const HarnessViewHooks* hooks = harness_gui_hooks();
+        if(hooks == NULL || hooks->type == NULL) {
+            harness_fail("Can't type in %s", harness_view_name(harness_gui_current()));
+            return;
+        }
+        stimulus_begin("type");
+        if(!hooks->type(hooks->module, args)) harness_fail("%s isn't valid input", args);
+        harness_gui_process();
+        stimulus_end();
+    } else if(strcmp(command, "answer") == 0 && args) {
+        harness_answer_push(args);
+    } else if(strcmp(command, "wait") == 0 && args) {
+        wait((uint32_t)atoi(args));
+    } else if(strcmp(command, "cli") == 0 && args) {
+        stimulus_begin("cli");
+        harness_cli_run(args, cli_reply, sizeof(cli_reply));
+        harness_gui_process();
+        stimulus_end();
+        if(verbose) fprintf(stderr, "    cli: %s\n", cli_reply);
+    } else if(strcmp(command, "tag") == 0 && args) {
+        tag_command(args);
+    } else if(strcmp(command, "file") == 0 && args) {
+        write_file(args);
+    } else {
+        harness_fail("Bad command: %s", command);
+    }
+}
+
+bool harness_step(void) {
+    // The app is idle: whatever started the last stimulus is handled
+    stimulus_end();
+    if(!heap.first_frame_taken) {
+        heap.first_frame_taken = true;
+        heap.first_frame = harness_heap_in_use() - heap.baseline;
+    }
+    while(script_next < script_count) {
+        script_line = script_next + 1;
+        char line[SCRIPT_LINE_SIZE];
+        snprintf(line, sizeof(line), "%s", script[script_next++]);
+        if(line[0] == '\0' || line[0] == '#') continue;
+        if(verbose) fprintf(stderr, "%zu: %s\n", script_line, line);
+        bool running = harness_gui_running();
+        run(line);
+        // Closing is timed until the app returned, see launch
+        if(running && !harness_gui_running()) stimulus_begin("close");
+        return true;
+    }
+    return false;
+}
+
+// Setup and report
+
+static bool read_script(const char* path) {
+    FILE* file = fopen(path, "r");
+    if(file == NULL) return false;
+    char line[SCRIPT_LINE_SIZE];
+    while(fgets(line, sizeof(line), file)) {
+        if(script_count == SCRIPT_LINES) {
+            fclose(file);
+            return false;
+        }
+        line[strcspn(line, "\r\n")] = '\0';
+        char* start = line;
+        while(isspace((unsigned char)*start)) start++;
+        size_t length = strlen(start);
+        while(length > 0 && isspace((unsigned char)start[length - 1])) start[--length] = '\0';
+        snprintf(script[script_count++], SCRIPT_LINE_SIZE, "%s", start);
+    }
+    fclose(file);
+    return true;
+}
+
+static void remove_root(const char* root) {
+    DIR* dir = opendir(root);
+    if(dir == NULL) return;
+    struct dirent* entry;
+    while((entry = readdir(dir)) != NULL) {
+        if(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        char path[HOST_PATH_SIZE];
+        snprintf(path, sizeof(path), "%s/%s", root, entry->d_name);
+        unlink(path);
+    }
+    closedir(dir);
+    rmdir(root);
+}
+
+static void report(void) {
+    printf("%-6s %-12s %-12s %5s %10s %10s %12s %12s\n",
+           "Input", "From", "To", "Count", "Mean us", "Max us", "Device ms", "Max dev ms");
+    for(size_t i = 0; i < transition_count; i++) {
+        Transition* transition = &transitions[i];
+        Latency* latency = &transition->latency;
+        printf(
+            "%-6s %-12s %-12s %5llu %10llu %10llu %12.1f %12.1f\n",
+            transition->kind,
+            harness_view_name(transition->from),
+            harness_view_name(transition->to),
+            (unsigned long long)latency->count,
+            (unsigned long long)(latency->real_total_us / latency->count),
+            (unsigned long long)latency->real_max_us,
+            latency->device_total_us / 1000.0 / latency->count,
+            latency->device_max_us / 1000.0);
+    }
+    printf("\n%-12s %6s %10s %10s %12s %12s\n",
+           "Redraw", "Count", "Mean us", "Max us", "Device ms", "Max dev ms");
+    for(uint32_t view = 0; view < REDRAW_VIEWS; view++) {
+        Latency* latency = &redraws[view];
+        if(latency->count == 0) continue;
+        printf(
+            "%-12s %6llu %10llu %10llu %12.1f %12.1f\n",
+            harness_view_name(view),
+            (unsigned long long)latency->count,
+            (unsigned long long)(latency->real_total_us / latency->count),
+            (unsigned long long)latency->real_max_us,
+            latency->device_total_us / 1000.0 / latency->count,
+            latency->device_max_us / 1000.0);
+    }
+    printf(
+        "\nHeap: %zu bytes at the first frame, %zu at the peak\n", heap.first_frame, heap.peak);
+}
+
+int main(int argc, char** argv) {
+    const char* root = NULL;
+    int arg = 1;
+    for(; arg < argc - 1; arg++) {
+        if(strcmp(argv[arg], "--root") == 0 && arg + 2 < argc) {
+            root = argv[++arg];
+        } else if(strcmp(argv[arg], "--verbose") == 0) {
+            verbose = true;
+        } else {
+            break;
+        }
+    }
+    if(arg != argc - 1) {
+        fprintf(stderr, "Usage: %s [--root DIR] [--verbose] SCRIPT\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    script_path = argv[arg];
+    if(!read_script(script_path)) {
+        fprintf(stderr, "Can't read %s\n", script_path);
+        return EXIT_FAILURE;
+    }
+    char temporary[] = "/tmp/t5577_harness_XXXXXX";
+    if(root == NULL) {
+        root = mkdtemp(temporary);
+        if(root == NULL) {
+            fprintf(stderr, "Can't make a data directory\n");
+            return EXIT_FAILURE;
+        }
+    }
+    harness_storage_set_root(root);
+    harness_tag_reset();
+    heap.first_frame_taken = true; // Until a launch
+
+    // Lines up to the first launch run before the app, the rest after it returns
+    while(harness_step()) {
+    }
+    script_line = script_count;
+    if(harness_answers_pending()) {
+        harness_fail("%zu answers were never asked for", harness_answers_pending());
+    }
+
+    report();
+    if(root == temporary) remove_root(root);
+    printf("%s: %s\n", script_path, failures ? "FAILED" : "passed");
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+// What t5577_harness.c and the fake SDK in t5577_fake_*.c share. The app itself only sees the
+// firmware's headers in stubs/.
+//
+// Everything runs on one thread. Device time is virtual: it moves when the harness waits for a
+// timer, and when the app blocks in furi_delay_us and furi_delay_ms, the way the write path does.
+// So a write on the Flipper takes as long in device time here, whatever the host's speed.
+#pragma once
+
+#include <furi.h>
+#include <gui/view.h>
+
+// One view id of the app, from the T5577WriterView enum in t5577_writer.c
+const char* harness_view_name(uint32_t view_id);
+
+// Reports a failed check or a misuse of the SDK and carries on, the run then fails
+void harness_fail(const char* format, ...) __attribute__((format(printf, 1, 2)));
+bool harness_verbose(void);
+
+// Device time
+uint64_t harness_now_us(void);
+void harness_advance_us(uint64_t us);
+// Fires the first timer due by until_us, with the time moved to when it was due. Returns false
+// if none is due, the time is then left alone.
+bool harness_timer_fire_next(uint64_t until_us);
+size_t harness_timers_running(void);
+
+// Heap, counted in __wrap_malloc and friends. Paused while the simulation itself allocates.
+size_t harness_heap_in_use(void);
+size_t harness_heap_peak(void);
+void harness_heap_reset_peak(void);
+void harness_heap_pause(bool paused);
+
+// Records the app still has open, by name, or NULL if none
+const char* harness_record_open_name(void);
+
+bool harness_log_contains(const char* text);
+void harness_log_clear(void);
+
+// Whether a notification sequence with this name was sent since the last clear
+bool harness_notification_seen(const char* name);
+void harness_notification_clear(void);
+
+// Runs a CLI line like "t5577 write 00148040" and puts what it printed in reply
+void harness_cli_run(const char* line, char* reply, size_t reply_size);
+
+// Storage: "/data" is a directory on the host
+void harness_storage_set_root(const char* root);
+bool harness_host_path(const char* path, char* host_path, size_t size);
+
+// The tag in front of the antenna
+void harness_tag_reset(void);
+void harness_tag_set_present(bool present);
+void harness_tag_set_block(uint8_t page, uint8_t block, uint32_t data);
+uint32_t harness_tag_block(uint8_t page, uint8_t block);
+bool harness_tag_locked(uint8_t page, uint8_t block);
+uint32_t harness_tag_writes(void); // Block writes the tag took
+
+// Dialogs: the answers to the next file browser and message dialogs, in order
+void harness_answer_push(const char* answer);
+size_t harness_answers_pending(void);
+const char* harness_last_dialog(void);
+
+// The GUI
+typedef struct {
+    // Index of the item with this label, -1 if there is none
+    int32_t (*find)(void* module, const char* label);
+    int32_t (*cursor)(void* module);
+    // Value shown for the item, NULL if it has none
+    const char* (*value)(void* module, int32_t index);
+    // Enters text like the user would and confirms it. Returns false if it isn't valid.
+    bool (*type)(void* module, const char* text);
+    void* module;
+} HarnessViewHooks;
+void view_set_harness_hooks(View* view, const HarnessViewHooks* hooks);
+const HarnessViewHooks* harness_gui_hooks(void); // Of the current view, NULL if it has none
+
+bool harness_gui_running(void); // The app's view dispatcher is running
+uint32_t harness_gui_current(void); // VIEW_NONE if there is no current view
+void harness_gui_input(InputKey key);
+// Runs the queued custom events and draws the frame they asked for, until there are none left
+void harness_gui_process(void);
+const char* harness_gui_screen(void); // Every string the last frame drew
+
+// Called from the fake GUI
+bool harness_step(void); // Runs the next line of the script, false at its end
+void harness_frame(uint32_t view_id, uint64_t real_us, uint64_t device_us);
@@ -0,0 +1,490 @@
+// Programs a batch of tags on several Flippers at once, over the app's "t5577" CLI command.
+//
+// t5577_orchestrator [--retries N] [--timeout-ms X] MANIFEST DEVICE...
+// t5577_orchestrator [--retries N] [--timeout-ms X] --simulate N [--speed X] [--fail X]
+//                    [--die N] MANIFEST
+//
+// Every line of MANIFEST is one tag: a name, then block 0 and up to 7 more blocks as 8 hex digits
+// each, like "t5577 write" takes them. '#' starts a comment. Each DEVICE is the USB serial port of
+// a Flipper with the app open, /dev/ttyACM0 and so on.
+//
+// The tags are dealt out round robin, one queue per station. A station takes from the front of
+// its own queue, and once that is empty steals from the back of the longest one, so fast stations
+// take over from slow ones. A tag that gets an error is queued again on a station that hasn't
+// failed it yet, up to --retries times. A station that doesn't answer within --timeout-ms, or
+// doesn't have the app open, is dropped; the tag it had is retried and its queue is stolen.
+//
+// --simulate runs N pty stations from t5577_station_sim instead of real devices: --speed scales
+// how long a write takes (1 is real time), --fail is the chance a write gets no reply and --die
+// makes the first station stop answering after that many writes.
+
+#define _XOPEN_SOURCE 700
+#define _DEFAULT_SOURCE
+
+#include "t5577_station_sim.h"
+
+#include <lib/lfrfid/tools/t5577.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ORCH_MAX_STATIONS 64 // Job.tried is a bit per station
+#define ORCH_RETRIES      2
+#define ORCH_TIMEOUT_MS   5000 // A write and its reply take about 1.2 s on a Flipper
+#define ORCH_NAME_SIZE    32
+#define ORCH_LINE_SIZE    256
+#define ORCH_REPLY_SIZE   1024
+#define ORCH_PROMPT       ">: "
+
+typedef struct {
+    char name[ORCH_NAME_SIZE];
+    uint32_t blocks[LFRFID_T5577_BLOCK_COUNT];
+    uint8_t block_count;
+    uint8_t attempts;
+    uint64_t tried; // Stations that failed it
+    bool written;
+    bool given_up;
+    char error[ORCH_NAME_SIZE]; // The last error it got
+} Job;
+
+// Indexes into the job list, in a ring so both ends are cheap
+typedef struct {
+    uint32_t* items;
+    uint32_t capacity;
+    uint32_t head;
+    uint32_t count;
+} Deque;
+
+typedef enum {
+    StationReplyOk, // The tag was written and replied at its clock
+    StationReplyError, // The station answered with an error for this tag
+    StationReplyLost, // The station didn't answer in time, or isn't running the app
+} StationReply;
+
+typedef struct Orchestrator Orchestrator;
+
+typedef struct {
+    Orchestrator* orch;
+    uint32_t index;
+    const char* path;
+    int fd;
+    bool dead;
+    Deque queue;
+    pthread_t thread;
+    uint32_t ok;
+    uint32_t failed;
+    uint32_t timeouts;
+    uint32_t stolen; // Tags it took from another station's queue
+    double ok_ms; // Time spent on tags that were written
+} Station;
+
+struct Orchestrator {
+    Job* jobs;
+    uint32_t job_count;
+    uint32_t outstanding; // Jobs neither written nor given up
+    Station stations[ORCH_MAX_STATIONS];
+    uint32_t station_count;
+    uint32_t retries;
+    uint32_t timeout_ms;
+    pthread_mutex_t mutex; // Guards the queues, the jobs and the station stats
+    pthread_cond_t changed; // A job was queued or finished
+};
+
+static double now_ms(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1e3 + time.tv_nsec / 1e6;
+}
+
+static void deque_init(Deque* deque, uint32_t capacity) {
+    deque->items = malloc((capacity ? capacity : 1) * sizeof(uint32_t));
+    deque->capacity = capacity ? capacity : 1;
+    deque->head = 0;
+    deque->count = 0;
+}
+
+static void deque_push_back(Deque* deque, uint32_t item) {
+    deque->items[(deque->head + deque->count++) % deque->capacity] = item;
+}
+
+static bool deque_pop_front(Deque* deque, uint32_t* item) {
+    if(deque->count == 0) return false;
+    *item = deque->items[deque->head];
+    deque->head = (deque->head + 1) % deque->capacity;
+    deque->count--;
+    return true;
+}
+
+static bool deque_pop_back(Deque* deque, uint32_t* item) {
+    if(deque->count == 0) return false;
+    *item = deque->items[(deque->head + --deque->count) % deque->capacity];
+    return true;
+}
+
+static bool manifest_load(Orchestrator* orch, const char* path) {
+    FILE* file = fopen(path, "r");
+    if(!file) {
+        fprintf(stderr, "%s: can't be opened\n", path);
+        return false;
+    }
+    char line[ORCH_LINE_SIZE];
+    uint32_t line_number = 0;
+    bool valid = true;
+    while(valid && fgets(line, sizeof(line), file)) {
+        line_number++;
+        char* comment = strchr(line, '#');
+        if(comment) *comment = '\0';
+        char* save;
+        char* name = strtok_r(line, " \t\r\n", &save);
+        if(!name) continue;
+        Job job;
+        memset(&job, 0, sizeof(job));
+        snprintf(job.name, sizeof(job.name), "%s", name);
+        for(char* word; valid && (word = strtok_r(NULL, " \t\r\n", &save));) {
+            char* end;
+            job.blocks[job.block_count] = strtoul(word, &end, 16);
+            valid = job.block_count < LFRFID_T5577_BLOCK_COUNT && strlen(word) == 8 && !*end;
+            job.block_count++;
+        }
+        if(!valid || job.block_count == 0) {
+            fprintf(
+                stderr,
+                "%s:%u: expected a name and 1 to 8 blocks of 8 hex digits\n",
+                path,
+                line_number);
+            valid = false;
+            break;
+        }
+        orch->jobs = realloc(orch->jobs, (orch->job_count + 1) * sizeof(Job));
+        orch->jobs[orch->job_count++] = job;
+    }
+    fclose(file);
+    return valid;
+}
+
+// Waits for the prompt, so the reply to the last line is all in. Returns false on a timeout.
+static bool station_read_reply(Station* station, char* reply, size_t reply_size) {
+    size_t length = 0;
+    double deadline = now_ms() + station->orch->timeout_ms;
+    reply[0] = '\0';
+    while(true) {
+        double left = deadline - now_ms();
+        if(left <= 0) return false;
+        struct pollfd poll_fd = {station->fd, POLLIN, 0};
+        if(poll(&poll_fd, 1, (int)left + 1) <= 0) continue;
+        char input[256];
+        ssize_t count = read(station->fd, input, sizeof(input));
+        if(count < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+        if(count <= 0) return false;
+        for(ssize_t i = 0; i < count && length + 1 < reply_size; i++) {
+            reply[length++] = input[i];
+        }
+        reply[length] = '\0';
+        if(length >= strlen(ORCH_PROMPT) &&
+           strcmp(reply + length - strlen(ORCH_PROMPT), ORCH_PROMPT) == 0) {
+            return true;
+        }
+        if(length + 1 == reply_size) return false;
+    }
+}
+
+static bool station_send(Station* station, const char* line) {
+    size_t length = strlen(line);
+    while(length > 0) {
+        ssize_t written = write(station->fd, line, length);
+        if(written < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+        if(written <= 0) return false;
+        line += written;
+        length -= written;
+    }
+    return true;
+}
+
+// Opens the port raw and gets to a fresh prompt, past the banner and whatever was typed before
+static bool station_open(Station* station) {
+    station->fd = open(station->path, O_RDWR | O_NOCTTY);
+    if(station->fd < 0) return false;
+    struct termios termios;
+    if(tcgetattr(station->fd, &termios) == 0) {
+        cfmakeraw(&termios);
+        cfsetspeed(&termios, B230400);
+        tcsetattr(station->fd, TCSANOW, &termios);
+    }
+    tcflush(station->fd, TCIOFLUSH);
+    char reply[ORCH_REPLY_SIZE];
+    return station_send(station, "\r") && station_read_reply(station, reply, sizeof(reply));
+}
+
+static StationReply station_write(Station* station, Job* job) {
+    char line[ORCH_LINE_SIZE];
+    int length = snprintf(line, sizeof(line), "t5577 write");
+    for(uint8_t i = 0; i < job->block_count; i++) {
+        length += snprintf(line + length, sizeof(line) - length, " %08X", job->blocks[i]);
+    }
+    snprintf(line + length, sizeof(line) - length, "\r");
+    char reply[ORCH_REPLY_SIZE];
+    if(!station_send(station, line) || !station_read_reply(station, reply, sizeof(reply))) {
+        snprintf(job->error, sizeof(job->error), "timeout");
+        return StationReplyLost;
+    }
+    // The echo of the command comes first, then one line with the answer
+    char* save;
+    for(char* answer = strtok_r(reply, "\r\n", &save); answer;
+        answer = strtok_r(NULL, "\r\n", &save)) {
+        if(strncmp(answer, "ok ", 3) == 0) return StationReplyOk;
+        if(strncmp(answer, "error ", 6) == 0) {
+            snprintf(job->error, sizeof(job->error), "%s", answer + 6);
+            return StationReplyError;
+        }
+    }
+    snprintf(job->error, sizeof(job->error), "app not open");
+    return StationReplyLost;
+}
+
+// Own queue first, then the back of the longest queue, a dead station's included. Needs the lock.
+static bool station_take(Station* station, uint32_t* job) {
+    if(!station->dead && deque_pop_front(&station->queue, job)) return true;
+    Orchestrator* orch = station->orch;
+    Station* victim = NULL;
+    for(uint32_t i = 0; i < orch->station_count; i++) {
+        Station* other = &orch->stations[i];
+        if(other->queue.count > 0 && (!victim || other->queue.count > victim->queue.count)) {
+            victim = other;
+        }
+    }
+    if(!victim || !deque_pop_back(&victim->queue, job)) return false;
+    station->stolen++;
+    return true;
+}
+
+// Queues a job that failed on this station again, on the live station with the shortest queue
+// that hasn't failed it, or gives up on it. Needs the lock.
+static void station_retry(Station* station, uint32_t index) {
+    Orchestrator* orch = station->orch;
+    Job* job = &orch->jobs[index];
+    job->attempts++;
+    job->tried |= 1ULL << station->index;
+    Station* target = NULL;
+    for(int pass = 0; pass < 2 && !target; pass++) {
+        for(uint32_t i = 0; i < orch->station_count; i++) {
+            Station* other = &orch->stations[i];
+            if(other->dead || (pass == 0 && (job->tried & (1ULL << i)))) continue;
+            if(!target || other->queue.count < target->queue.count) target = other;
+        }
+    }
+    if(job->attempts > orch->retries || !target) {
+        job->given_up = true;
+        orch->outstanding--;
+        return;
+    }
+    deque_push_back(&target->queue, index);
+}
+
+static void* station_thread(void* context) {
+    Station* station = context;
+    Orchestrator* orch = station->orch;
+    bool opened = station_open(station);
+    pthread_mutex_lock(&orch->mutex);
+    if(!opened) {
+        fprintf(stderr, "%s: no prompt, dropped\n", station->path);
+        station->dead = true;
+    }
+    while(!station->dead && orch->outstanding > 0) {
+        uint32_t index;
+        if(!station_take(station, &index)) {
+            pthread_cond_wait(&orch->changed, &orch->mutex);
+            continue;
+        }
+        Job* job = &orch->jobs[index];
+        pthread_mutex_unlock(&orch->mutex);
+        double start_ms = now_ms();
+        StationReply reply = station_write(station, job);
+        double elapsed_ms = now_ms() - start_ms;
+        pthread_mutex_lock(&orch->mutex);
+        switch(reply) {
+        case StationReplyOk:
+            job->written = true;
+            orch->outstanding--;
+            station->ok++;
+            station->ok_ms += elapsed_ms;
+            break;
+        case StationReplyError:
+            station->failed++;
+            station_retry(station, index);
+            break;
+        case StationReplyLost:
+            fprintf(stderr, "%s: %s, dropped\n", station->path, job->error);
+            station->timeouts++;
+            station->dead = true;
+            station_retry(station, index);
+            break;
+        }
+        pthread_cond_broadcast(&orch->changed);
+    }
+    // The last live station going leaves nobody to wake the others, so wake them either way
+    pthread_cond_broadcast(&orch->changed);
+    pthread_mutex_unlock(&orch->mutex);
+    if(station->fd >= 0) close(station->fd);
+    return NULL;
+}
+
+static void orchestrator_report(const Orchestrator* orch, double wall_ms) {
+    printf(
+        "%-16s %5s %6s %8s %6s %9s %8s %7s\n",
+        "station",
+        "ok",
+        "failed",
+        "timeouts",
+        "stolen",
+        "tags/min",
+        "mean ms",
+        "errors");
+    for(uint32_t i = 0; i < orch->station_count; i++) {
+        const Station* station = &orch->stations[i];
+        uint32_t tries = station->ok + station->failed + station->timeouts;
+        printf(
+            "%-16s %5u %6u %8u %6u %9.1f %8.0f %6.1f%%%s\n",
+            station->path,
+            station->ok,
+            station->failed,
+            station->timeouts,
+            station->stolen,
+            wall_ms > 0 ? station->ok * 60000.0 / wall_ms : 0.0,
+            station->ok ? station->ok_ms / station->ok : 0.0,
+            tries ? 100.0 * (station->failed + station->timeouts) / tries : 0.0,
+            station->dead ? " dropped" : "");
+    }
+    uint32_t written = 0;
+    for(uint32_t i = 0; i < orch->job_count; i++) {
+        const Job* job = &orch->jobs[i];
+        if(job->written) {
+            written++;
+        } else {
+            printf("%s: not written after %u tries, %s\n", job->name, job->attempts, job->error);
+        }
+    }
+    printf(
+        "%u of %u tags written in %.1f s, %.1f tags/min\n",
+        written,
+        orch->job_count,
+        wall_ms / 1000.0,
+        wall_ms > 0 ? written * 60000.0 / wall_ms : 0.0);
+}
+
+static bool orch_option(int argc, char** argv, int* i, const char* name, double* value) {
+    if(strcmp(argv[*i], name) != 0 || *i + 1 >= argc) return false;
+    *value = strtod(argv[++*i], NULL);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Orchestrator orch;
+    memset(&orch, 0, sizeof(orch));
+    orch.retries = ORCH_RETRIES;
+    orch.timeout_ms = ORCH_TIMEOUT_MS;
+    StationSimOptions sim_options = {1.0, 0.0, -1, 0};
+    double simulate = 0, value;
+    const char* manifest = NULL;
+    const char* paths[ORCH_MAX_STATIONS];
+    uint32_t path_count = 0;
+    for(int i = 1; i < argc; i++) {
+        if(orch_option(argc, argv, &i, "--retries", &value)) {
+            orch.retries = value > 0 ? (uint32_t)value : 0;
+        } else if(orch_option(argc, argv, &i, "--timeout-ms", &value)) {
+            orch.timeout_ms = value > 0 ? (uint32_t)value : 1;
+        } else if(orch_option(argc, argv, &i, "--simulate", &simulate)) {
+        } else if(orch_option(argc, argv, &i, "--speed", &sim_options.speed)) {
+        } else if(orch_option(argc, argv, &i, "--fail", &sim_options.fail)) {
+        } else if(orch_option(argc, argv, &i, "--die", &value)) {
+            sim_options.die_after = (int)value;
+        } else if(strncmp(argv[i], "--", 2) == 0) {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return EXIT_FAILURE;
+        } else if(!manifest) {
+            manifest = argv[i];
+        } else if(path_count < ORCH_MAX_STATIONS) {
+            paths[path_count++] = argv[i];
+        }
+    }
+    if(simulate > ORCH_MAX_STATIONS) simulate = ORCH_MAX_STATIONS;
+    if(!manifest || (path_count == 0) == (simulate < 1)) {
+        fprintf(
+            stderr,
+            "t5577_orchestrator [--retries N] [--timeout-ms X] MANIFEST DEVICE...\n"
+            "t5577_orchestrator [--retries N] [--timeout-ms X] --simulate N [--speed X] "
+            "[--fail X] [--die N] MANIFEST\n");
+        return EXIT_FAILURE;
+    }
+    if(!manifest_load(&orch, manifest)) return EXIT_FAILURE;
+
+    StationSim* sims[ORCH_MAX_STATIONS];
+    for(uint32_t i = 0; i < (uint32_t)simulate; i++) {
+        StationSimOptions options = sim_options;
+        options.seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+        if(i > 0) options.die_after = -1;
+        sims[i] = station_sim_start(&options);
+        if(!sims[i]) {
+            fprintf(stderr, "No pty for a simulated station\n");
+            return EXIT_FAILURE;
+        }
+        paths[path_count++] = station_sim_path(sims[i]);
+    }
+
+    pthread_mutex_init(&orch.mutex, NULL);
+    pthread_cond_init(&orch.changed, NULL);
+    orch.station_count = path_count;
+    orch.outstanding = orch.job_count;
+    for(uint32_t i = 0; i < path_count; i++) {
+        Station* station = &orch.stations[i];
+        station->orch = &orch;
+        station->index = i;
+        station->path = paths[i];
+        station->fd = -1;
+        deque_init(&station->queue, orch.job_count);
+    }
+    for(uint32_t j = 0; j < orch.job_count; j++) {
+        deque_push_back(&orch.stations[j % path_count].queue, j);
+    }
+
+    double start_ms = now_ms();
+    for(uint32_t i = 0; i < path_count; i++) {
+        pthread_create(&orch.stations[i].thread, NULL, station_thread, &orch.stations[i]);
+    }
+    for(uint32_t i = 0; i < path_count; i++) {
+        pthread_join(orch.stations[i].thread, NULL);
+    }
+    double wall_ms = now_ms() - start_ms;
+
+    // Left in a queue when every station was dropped
+    for(uint32_t j = 0; j < orch.job_count; j++) {
+        Job* job = &orch.jobs[j];
+        if(!job->written && !job->given_up && !job->error[0]) {
+            snprintf(job->error, sizeof(job->error), "no station left");
+        }
+    }
+    orchestrator_report(&orch, wall_ms);
+
+    bool pass = orch.outstanding == 0;
+    for(uint32_t j = 0; j < orch.job_count; j++) {
+        if(!orch.jobs[j].written) pass = false;
+    }
+    for(uint32_t i = 0; i < (uint32_t)simulate; i++) {
+        station_sim_stop(sims[i]);
+    }
+    for(uint32_t i = 0; i < path_count; i++) {
+        free(orch.stations[i].queue.items);
+    }
+    free(orch.jobs);
+    pthread_cond_destroy(&orch.changed);
+    pthread_mutex_destroy(&orch.mutex);
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
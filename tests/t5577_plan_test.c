@@ -0,0 +1,322 @@
+// Host checks for t5577_plan: the bits of each block write, the order a tag's writes go out in,
+// the air time it reports and that a clean plan isn't rebuilt.
+
+#include "t5577_plan.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                 \
+    do {                                                                 \
+        if(!(condition)) {                                               \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                  \
+        }                                                                \
+    } while(0)
+
+// The command's bits as a string of 0 and 1, MSB first
+static void plan_bits(const T5577PlanCommand* command, char* out) {
+    for(uint8_t i = 0; i < command->bit_count; i++) {
+        out[i] = t5577_plan_bit(command, i) ? '1' : '0';
+    }
+    out[command->bit_count] = '\0';
+}
+
+static void append_bits(char* out, uint32_t value, uint8_t count) {
+    size_t length = strlen(out);
+    for(uint8_t i = 0; i < count; i++) {
+        out[length + i] = ((value >> (count - 1 - i)) & 1) ? '1' : '0';
+    }
+    out[length + count] = '\0';
+}
+
+static uint32_t bit_cycles(const T5577PlanCommand* command) {
+    uint32_t cycles = 0;
+    for(uint8_t i = 0; i < command->bit_count; i++) {
+        bool value = t5577_plan_bit(command, i);
+        cycles += (value ? T5577_TIMING_DATA_1 : T5577_TIMING_DATA_0) + T5577_TIMING_WRITE_GAP;
+    }
+    return cycles;
+}
+
+// Read back what a command writes, so the order can be checked without decoding by hand
+typedef struct {
+    uint8_t page;
+    bool with_pass;
+    uint32_t password;
+    bool lock;
+    uint32_t data;
+    uint8_t block;
+} Decoded;
+
+static uint32_t take_bits(const T5577PlanCommand* command, uint8_t* index, uint8_t count) {
+    uint32_t value = 0;
+    for(uint8_t i = 0; i < count; i++, (*index)++) {
+        value = (value << 1) | t5577_plan_bit(command, *index);
+    }
+    return value;
+}
+
+static Decoded decode(const T5577PlanCommand* command) {
+    Decoded decoded = {0};
+    uint8_t index = 0;
+    decoded.page = take_bits(command, &index, 2) & 1;
+    decoded.with_pass = command->bit_count == T5577_PLAN_MAX_BITS;
+    if(decoded.with_pass) decoded.password = take_bits(command, &index, 32);
+    decoded.lock = take_bits(command, &index, 1);
+    decoded.data = take_bits(command, &index, 32);
+    decoded.block = take_bits(command, &index, 3);
+    return decoded;
+}
+
+static void check_command(
+    const T5577Plan* plan,
+    uint8_t c,
+    uint8_t page,
+    uint8_t block,
+    uint32_t data,
+    bool lock,
+    bool with_pass,
+    uint32_t password) {
+    Decoded decoded = decode(&plan->commands[c]);
+    bool pass = decoded.page == page && decoded.block == block && decoded.data == data &&
+                decoded.lock == lock && decoded.with_pass == with_pass &&
+                (!with_pass || decoded.password == password);
+    if(!pass) {
+        printf(
+            "FAIL command %u: page %u block %u data %08X lock %u pass %u\n",
+            c,
+            decoded.page,
+            decoded.block,
+            (unsigned)decoded.data,
+            decoded.lock,
+            decoded.with_pass);
+        failures++;
+    }
+}
+
+// Page 0 without a password: opcode 10, lock, 32 data bits, 3 address bits
+static void check_page_0_layout(void) {
+    T5577Plan plan;
+    t5577_plan_clear(&plan);
+    CHECK(t5577_plan_add_block(&plan, 0, 5, 0xA5C3F00Fu, true, false, 0xFFFFFFFFu));
+    char bits[T5577_PLAN_MAX_BITS + 1];
+    char expected[T5577_PLAN_MAX_BITS + 1] = "101";
+    append_bits(expected, 0xA5C3F00Fu, 32);
+    append_bits(expected, 5, 3);
+    plan_bits(&plan.commands[0], bits);
+    CHECK(plan.commands[0].bit_count == 38);
+    CHECK(strcmp(bits, expected) == 0);
+}
+
+// Page 1 with a password: opcode 11, password, lock, data, address
+static void check_password_layout(void) {
+    T5577Plan plan;
+    t5577_plan_clear(&plan);
+    CHECK(t5577_plan_add_block(&plan, 1, 3, 0x00000001u, false, true, 0x51243648u));
+    char bits[T5577_PLAN_MAX_BITS + 1];
+    char expected[T5577_PLAN_MAX_BITS + 1] = "11";
+    append_bits(expected, 0x51243648u, 32);
+    append_bits(expected, 0, 1);
+    append_bits(expected, 0x00000001u, 32);
+    append_bits(expected, 3, 3);
+    plan_bits(&plan.commands[0], bits);
+    CHECK(plan.commands[0].bit_count == T5577_PLAN_MAX_BITS);
+    CHECK(strcmp(bits, expected) == 0);
+}
+
+// Every block costs wait, start gap, bits, program, wait and a reset; the session ends with one
+// more reset. The reset is a start gap, then 1 and 0, as in the firmware.
+static void check_air_time(void) {
+    uint32_t reset = T5577_TIMING_START_GAP + (T5577_TIMING_DATA_1 + T5577_TIMING_WRITE_GAP) +
+                     (T5577_TIMING_DATA_0 + T5577_TIMING_WRITE_GAP);
+    CHECK(reset == 146);
+
+    T5577Plan plan;
+    t5577_plan_clear(&plan);
+    CHECK(plan.air_time_us == reset * T5577_PLAN_RF_CYCLE_US);
+
+    // Block 0 set to 0: opcode 10, then 36 zeros
+    t5577_plan_add_block(&plan, 0, 0, 0, false, false, 0);
+    CHECK(plan.air_time_us == 27600);
+
+    // Any mix of pages, passwords and bits adds up the same way
+    t5577_plan_add_block(&plan, 0, 1, 0x11111111u, false, true, 0x12345678u);
+    t5577_plan_add_block(&plan, 1, 3, 0xFFFFFFFFu, true, true, 0x12345678u);
+    uint32_t cycles = reset;
+    for(uint8_t c = 0; c < plan.command_count; c++) {
+        cycles += T5577_TIMING_WAIT_TIME + T5577_TIMING_START_GAP +
+                  bit_cycles(&plan.commands[c]) + T5577_TIMING_PROGRAM +
+                  T5577_TIMING_WAIT_TIME + reset;
+    }
+    CHECK(plan.air_time_us == cycles * T5577_PLAN_RF_CYCLE_US);
+}
+
+// Without a password: blocks 1 to the max block, block 0 last, nothing carries a password
+static void check_build_plain(void) {
+    T5577PlanTag tag = {
+        .block_zero = 0x000880E0u,
+        .content = {0, 1, 2, 3, 4, 5, 6, 7},
+        .user_block_num = 7,
+        .password = 0x12345678u,
+    };
+    T5577Plan plan;
+    t5577_plan_build(&plan, &tag);
+    CHECK(plan.command_count == 8);
+    for(uint8_t i = 1; i <= 7; i++) {
+        check_command(&plan, i - 1, 0, i, i, false, false, 0);
+    }
+    check_command(&plan, 7, 0, 0, tag.block_zero, false, false, 0);
+}
+
+// With a password block 7 is the password, not data, and every write carries it
+static void check_build_password(void) {
+    T5577PlanTag tag = {
+        .block_zero = 0x000880F0u,
+        .content = {0, 1, 2, 3, 4, 5, 6, 7},
+        .user_block_num = 7,
+        .use_password = true,
+        .password = 0x12345678u,
+    };
+    T5577Plan plan;
+    t5577_plan_build(&plan, &tag);
+    CHECK(plan.command_count == 8);
+    for(uint8_t i = 1; i <= 6; i++) {
+        check_command(&plan, i - 1, 0, i, i, false, true, tag.password);
+    }
+    check_command(&plan, 6, 0, 7, tag.password, false, true, tag.password);
+    check_command(&plan, 7, 0, 0, tag.block_zero, false, true, tag.password);
+}
+
+// Everything at once: 6 data blocks, page 1 blocks 1-3, block 7 and block 0, all unlocked, then
+// the lock pass in the same order
+static void check_build_full(void) {
+    T5577PlanTag tag = {
+        .block_zero = 0x000880F0u,
+        .content = {0, 1, 2, 3, 4, 5, 6, 7},
+        .user_block_num = 7,
+        .page_1 = {0, 0x11u, 0x12u, 0x13u},
+        .write_page_1 = true,
+        .use_password = true,
+        .password = 0xCAFEF00Du,
+        // Page 0 blocks 2 and 7, page 1 block 3. Bit 0 is set but block 0 is never locked.
+        .lock_mask = (1 << 0) | (1 << 2) | (1 << 7) | (1 << 10),
+    };
+    T5577Plan plan;
+    t5577_plan_build(&plan, &tag);
+    CHECK(plan.command_count == T5577_PLAN_MAX_WRITES + 3);
+    CHECK(plan.lock_count == 3);
+    for(uint8_t i = 1; i <= 6; i++) {
+        check_command(&plan, i - 1, 0, i, i, false, true, tag.password);
+    }
+    check_command(&plan, 6, 1, 1, 0x11u, false, true, tag.password);
+    check_command(&plan, 7, 1, 2, 0x12u, false, true, tag.password);
+    check_command(&plan, 8, 1, 3, 0x13u, false, true, tag.password);
+    check_command(&plan, 9, 0, 7, tag.password, false, true, tag.password);
+    check_command(&plan, 10, 0, 0, tag.block_zero, false, true, tag.password);
+    check_command(&plan, 11, 0, 2, 2, true, true, tag.password);
+    check_command(&plan, 12, 1, 3, 0x13u, true, true, tag.password);
+    check_command(&plan, 13, 0, 7, tag.password, true, true, tag.password);
+
+    uint32_t lock_air_time_us = 0;
+    for(uint8_t c = plan.command_count - plan.lock_count; c < plan.command_count; c++) {
+        lock_air_time_us += T5577_TIMING_WAIT_TIME + T5577_TIMING_START_GAP +
+                            bit_cycles(&plan.commands[c]) + T5577_TIMING_PROGRAM +
+                            T5577_TIMING_WAIT_TIME + 146;
+    }
+    CHECK(plan.lock_air_time_us == lock_air_time_us * T5577_PLAN_RF_CYCLE_US);
+}
+
+// A lock bit must never reach the tag before every block has gone out unlocked
+static void check_locks_last(void) {
+    for(uint32_t lock_mask = 0; lock_mask < (1 << T5577_PLAN_MAX_WRITES); lock_mask++) {
+        T5577PlanTag tag = {
+            .user_block_num = 7,
+            .write_page_1 = true,
+            .use_password = lock_mask & 1, // Block 7 is the password on every other mask
+            .password = 0x12345678u,
+            .lock_mask = lock_mask,
+        };
+        T5577Plan plan;
+        t5577_plan_build(&plan, &tag);
+        uint8_t unlocked_count = plan.command_count - plan.lock_count;
+        bool pass = unlocked_count == T5577_PLAN_MAX_WRITES;
+        for(uint8_t c = 0; c < plan.command_count; c++) {
+            if(decode(&plan.commands[c]).lock != (c >= unlocked_count)) pass = false;
+        }
+        if(!pass) {
+            printf("FAIL lock mask %03X: a lock goes out before the lock pass\n", lock_mask);
+            failures++;
+        }
+    }
+}
+
+// Every block and every lock but block 0 fills the plan, and one more write is refused
+static void check_build_capacity(void) {
+    T5577PlanTag tag = {
+        .user_block_num = 7,
+        .write_page_1 = true,
+        .lock_mask = (1 << T5577_PLAN_MAX_WRITES) - 1,
+    };
+    T5577Plan plan;
+    t5577_plan_build(&plan, &tag);
+    CHECK(plan.command_count == T5577_PLAN_MAX_COMMANDS);
+    CHECK(plan.lock_count == T5577_PLAN_MAX_WRITES - 1);
+    CHECK(!t5577_plan_add_block(&plan, 0, 1, 0, false, false, 0));
+    CHECK(plan.command_count == T5577_PLAN_MAX_COMMANDS);
+}
+
+// Stands in for the app's build callback and counts how often it runs
+typedef struct {
+    uint32_t data;
+    uint32_t builds;
+} BuildContext;
+
+static void build_counted(T5577Plan* plan, void* context) {
+    BuildContext* build = context;
+    build->builds++;
+    t5577_plan_clear(plan);
+    t5577_plan_add_block(plan, 0, 1, build->data, false, false, 0);
+}
+
+static void check_update(void) {
+    BuildContext build = {.data = 0xCAFEBABEu};
+    T5577Plan plan;
+    bool dirty = true;
+    CHECK(t5577_plan_update(&plan, &dirty, build_counted, &build));
+    CHECK(!dirty);
+    CHECK(build.builds == 1);
+
+    // A clean plan is left alone even if what it was built from changed under it
+    T5577Plan before = plan;
+    build.data = 0x8BADF00Du;
+    CHECK(!t5577_plan_update(&plan, &dirty, build_counted, &build));
+    CHECK(build.builds == 1);
+    CHECK(memcmp(&plan, &before, sizeof(T5577Plan)) == 0);
+
+    dirty = true;
+    CHECK(t5577_plan_update(&plan, &dirty, build_counted, &build));
+    CHECK(build.builds == 2);
+    CHECK(memcmp(&plan, &before, sizeof(T5577Plan)) != 0);
+}
+
+int main(void) {
+    check_page_0_layout();
+    check_password_layout();
+    check_air_time();
+    check_build_plain();
+    check_build_password();
+    check_build_full();
+    check_locks_last();
+    check_build_capacity();
+    check_update();
+    if(failures) {
+        printf("%d failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,94 @@
+#include "t5577_raw_file.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+bool raw_file_open_read(RawFile* raw, const char* path) {
+    memset(raw, 0, sizeof(RawFile));
+    raw->file = fopen(path, "rb");
+    if(!raw->file) return false;
+    if(fread(&raw->header, sizeof(RawFileHeader), 1, raw->file) != 1 ||
+       raw->header.magic != RAW_FILE_MAGIC || raw->header.version != RAW_FILE_VERSION) {
+        return false;
+    }
+    raw->buffer = malloc(raw->header.max_buffer_size);
+    return true;
+}
+
+void raw_file_close(RawFile* raw) {
+    if(raw->file) fclose(raw->file);
+    free(raw->buffer);
+    memset(raw, 0, sizeof(RawFile));
+}
+
+static size_t varint_unpack(const uint8_t* data, size_t length, uint32_t* value) {
+    uint32_t result = 0;
+    for(size_t i = 0; i < length && i < 5; i++) {
+        result |= (uint32_t)(data[i] & 0x7F) << (7 * i);
+        if(!(data[i] & 0x80)) {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+bool raw_file_read_pair(RawFile* raw, uint32_t* duration, uint32_t* pulse, bool* pass_end) {
+    if(raw->buffer_counter >= raw->buffer_size) {
+        int next = fgetc(raw->file);
+        if(next == EOF) {
+            fseek(raw->file, sizeof(RawFileHeader), SEEK_SET);
+            if(pass_end) *pass_end = true;
+        } else {
+            ungetc(next, raw->file);
+        }
+        if(fread(&raw->buffer_size, sizeof(uint32_t), 1, raw->file) != 1) return false;
+        if(raw->buffer_size > raw->header.max_buffer_size) return false;
+        if(fread(raw->buffer, 1, raw->buffer_size, raw->file) != raw->buffer_size) return false;
+        raw->buffer_counter = 0;
+    }
+    const uint8_t* data = &raw->buffer[raw->buffer_counter];
+    size_t length = raw->buffer_size - raw->buffer_counter;
+    size_t first = varint_unpack(data, length, duration);
+    size_t second = first ? varint_unpack(data + first, length - first, pulse) : 0;
+    if(!second) return false;
+    raw->buffer_counter += first + second;
+    return true;
+}
+
+static size_t varint_pack(uint32_t value, uint8_t* data) {
+    size_t i = 0;
+    while(value >= 0x80) {
+        data[i++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    data[i++] = (uint8_t)value;
+    return i;
+}
+
+static bool raw_file_write_buffer(FILE* file, const uint8_t* buffer, uint32_t size) {
+    return fwrite(&size, sizeof(uint32_t), 1, file) == 1 &&
+           fwrite(buffer, 1, size, file) == size;
+}
+
+bool raw_file_write(const char* path, float frequency, const Capture* capture) {
+    FILE* file = fopen(path, "wb");
+    if(!file) return false;
+    RawFileHeader header = {RAW_FILE_MAGIC, RAW_FILE_VERSION, frequency, 0.5f, RAW_BUFFER_SIZE};
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    uint8_t buffer[RAW_BUFFER_SIZE];
+    uint32_t size = 0;
+    for(size_t i = 0; written && capture && i < capture->count; i++) {
+        uint8_t pair[10];
+        size_t length = varint_pack(capture->durations[i], pair);
+        length += varint_pack(capture->pulses[i], pair + length);
+        if(size + length > RAW_BUFFER_SIZE) {
+            written = raw_file_write_buffer(file, buffer, size);
+            size = 0;
+        }
+        memcpy(buffer + size, pair, length);
+        size += length;
+    }
+    if(written && size) written = raw_file_write_buffer(file, buffer, size);
+    return fclose(file) == 0 && written;
+}
@@ -0,0 +1,44 @@
+// The firmware's .raw capture files on the host, for t5577_raw_replay and the harness's raw read.
+//
+// The file layout is the firmware's lib/lfrfid/lfrfid_raw_file.c on a little endian, 32 bit
+// target: a header, then buffers of at most max_buffer_size bytes, each after its size as a
+// uint32. A buffer holds pairs of LEB128 varints, the period then the high time, in microseconds.
+#pragma once
+
+#include "t5577_capture_synth.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define RAW_FILE_MAGIC   0x4C464952
+#define RAW_FILE_VERSION 1
+#define RAW_BUFFER_SIZE  2048 // What the firmware's raw worker streams at most per buffer
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    float frequency;
+    float duty_cycle;
+    uint32_t max_buffer_size;
+} RawFileHeader;
+
+typedef struct {
+    FILE* file;
+    RawFileHeader header;
+    uint8_t* buffer;
+    uint32_t buffer_size;
+    uint32_t buffer_counter;
+} RawFile;
+
+// Returns false if the file can't be opened or isn't a capture. Close it either way.
+bool raw_file_open_read(RawFile* raw, const char* path);
+
+void raw_file_close(RawFile* raw);
+
+// Like lfrfid_raw_file_read_pair: at the end of the file it starts over after the header and sets
+// pass_end, so a reader has to stop on pass_end, not on a false return
+bool raw_file_read_pair(RawFile* raw, uint32_t* duration, uint32_t* pulse, bool* pass_end);
+
+// Writes the capture as a file recorded at this frequency. Without a capture, only the header.
+bool raw_file_write(const char* path, float frequency, const Capture* capture);
@@ -0,0 +1,121 @@
+// Replays a raw capture from the capture screen through t5577_detect, the same way 'Detect' does
+// on the Flipper, and prints what was found.
+//
+// t5577_raw_replay FILE.raw [--expect MODULATION RF_CLOCK]
+// t5577_raw_replay --synth FILE.raw MODULATION RF_CLOCK
+//
+// MODULATION is a name from the 'Config' menu ("ASK/MC", "FSK2a", ...), RF_CLOCK the divider
+// (64 for RF/64). --expect exits with a failure unless the capture is detected as that, up to the
+// modulations the envelope can't tell apart. --synth writes a capture of random data sent with
+// that modulation and RF clock instead, so there is a .raw file to replay without a Flipper.
+//
+// The file format is described in t5577_raw_file.h.
+
+#include "t5577_detect.h"
+#include "t5577_raw_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool parse_config(const char* name, const char* clock, uint8_t* m, uint8_t* c) {
+    uint32_t rf_clock = strtoul(clock, NULL, 10);
+    for(*m = 0; *m < MODULATION_NUM; (*m)++) {
+        if(strcmp(all_mods[*m].modulation_name, name) == 0) break;
+    }
+    for(*c = 0; *c < CLOCK_NUM; (*c)++) {
+        if(all_rf_clocks[*c].rf_clock_num == rf_clock) break;
+    }
+    if(*m == MODULATION_NUM || *c == CLOCK_NUM) {
+        fprintf(stderr, "Unknown modulation %s or RF clock %s\n", name, clock);
+        return false;
+    }
+    return true;
+}
+
+static int synth(const char* path, const char* name, const char* clock) {
+    uint8_t m, c;
+    if(!parse_config(name, clock, &m, &c)) return EXIT_FAILURE;
+    Capture capture;
+    capture_init(&capture, T5577_DETECT_FREQUENCY, 1, 0x5EED + m * 31 + c);
+    capture_generate(&capture, all_mods[m].mod_page_zero, all_rf_clocks[c].rf_clock_num);
+    bool written = raw_file_write(path, T5577_DETECT_FREQUENCY, &capture);
+    printf(
+        "%s: %s RF/%u, %zu periods%s\n",
+        path,
+        all_mods[m].modulation_name,
+        all_rf_clocks[c].rf_clock_num,
+        capture.count,
+        written ? "" : ", couldn't be written");
+    capture_free(&capture);
+    return written ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int replay(const char* path, const char* expect_name, const char* expect_clock) {
+    uint8_t expect_m = 0, expect_c = 0;
+    if(expect_name && !parse_config(expect_name, expect_clock, &expect_m, &expect_c)) {
+        return EXIT_FAILURE;
+    }
+    RawFile raw;
+    if(!raw_file_open_read(&raw, path)) {
+        fprintf(stderr, "%s: not a raw capture\n", path);
+        raw_file_close(&raw);
+        return EXIT_FAILURE;
+    }
+    printf(
+        "%s: %.0f Hz, %.2f duty, buffers of %u bytes\n",
+        path,
+        raw.header.frequency,
+        raw.header.duty_cycle,
+        raw.header.max_buffer_size);
+
+    // The same loop as t5577_writer_detect_read_file
+    T5577Detect* detect = t5577_detect_alloc();
+    bool supported = t5577_detect_reset(detect, raw.header.frequency);
+    uint32_t pairs = 0;
+    uint32_t duration, pulse;
+    bool pass_end = false;
+    while(supported && raw_file_read_pair(&raw, &duration, &pulse, &pass_end) && !pass_end) {
+        t5577_detect_feed(detect, duration, pulse);
+        pairs++;
+    }
+    raw_file_close(&raw);
+
+    T5577DetectResult result;
+    bool found = t5577_detect_result(detect, &result);
+    t5577_detect_free(detect);
+    if(!supported) {
+        printf("Can't detect from a capture at this frequency\n");
+    } else if(found) {
+        printf(
+            "%u periods: %s RF/%u, %u%%\n",
+            pairs,
+            all_mods[result.modulation_index].modulation_name,
+            all_rf_clocks[result.rf_clock_index].rf_clock_num,
+            result.confidence);
+    } else {
+        printf("%u periods: no match\n", pairs);
+    }
+    if(!expect_name) return found ? EXIT_SUCCESS : EXIT_FAILURE;
+    bool pass = found && result.rf_clock_index == expect_c &&
+                modulation_group(all_mods[result.modulation_index].mod_page_zero) ==
+                    modulation_group(all_mods[expect_m].mod_page_zero);
+    if(!pass) {
+        printf(
+            "Expected %s RF/%u\n",
+            all_mods[expect_m].modulation_name,
+            all_rf_clocks[expect_c].rf_clock_num);
+    }
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char** argv) {
+    if(argc == 5 && strcmp(argv[1], "--synth") == 0) return synth(argv[2], argv[3], argv[4]);
+    if(argc == 2) return replay(argv[1], NULL, NULL);
+    if(argc == 5 && strcmp(argv[2], "--expect") == 0) return replay(argv[1], argv[3], argv[4]);
+    fprintf(
+        stderr,
+        "t5577_raw_replay FILE.raw [--expect MODULATION RF_CLOCK]\n"
+        "t5577_raw_replay --synth FILE.raw MODULATION RF_CLOCK\n");
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,209 @@
+// Password recovery benchmark: walks a dictionary against a simulated locked tag the way the
+// 'Clear Password' screen does, and reports attempts per second, the time until the password is
+// known and how often it is found, for a few batch sizes.
+//
+// t5577_recover_bench [--trials N] [--seed N] [--dictionary N] [--read-ms X] [--miss X]
+//
+// Every candidate costs the air time of a block 0 password write, from t5577_plan. A batch is
+// followed by one raw read of the tag's reply, and a hit by a bisection of that batch. A read
+// misses a change of the reply with probability 'miss'; the tag itself never drops a write.
+
+#include "t5577_plan.h"
+#include "t5577_recover.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The app's current settings, from t5577_writer.c
+#define BENCH_READ_MS  250 // REPLY_READ_MS
+
+// An EM4100 config with the password bit, at the two RF clocks the probes use
+#define BENCH_BLOCK_ZERO \
+    (LFRFID_T5577_MODULATION_MANCHESTER | (2 << LFRFID_T5577_MAXBLOCK_SHIFT) | LFRFID_T5577_PWD)
+#define BENCH_PROBE_0 (BENCH_BLOCK_ZERO | LFRFID_T5577_BITRATE_RF_64)
+#define BENCH_PROBE_1 (BENCH_BLOCK_ZERO | LFRFID_T5577_BITRATE_RF_32)
+
+#define BENCH_TRIALS         500
+#define BENCH_DICTIONARY     2000
+#define BENCH_READ_SETTLE_US 5000 // Field on and tag reset before a read can start
+
+typedef struct {
+    uint32_t trials;
+    uint64_t seed;
+    uint32_t dictionary;
+    double read_ms;
+    double miss;
+} BenchOptions;
+
+typedef struct {
+    const BenchOptions* options;
+    uint64_t rng;
+    uint32_t* dictionary;
+    uint32_t password;
+    uint8_t tag_probe; // The probe the tag took last, 2 for the config it came with
+    double now_us;
+} BenchSim;
+
+static uint64_t sim_next(BenchSim* sim) {
+    // xorshift64*, so every run sees the same tags
+    sim->rng ^= sim->rng >> 12;
+    sim->rng ^= sim->rng << 25;
+    sim->rng ^= sim->rng >> 27;
+    return sim->rng * 0x2545F4914F6CDD1DULL;
+}
+
+static double sim_random(BenchSim* sim) {
+    return (sim_next(sim) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static uint32_t sim_write_us(uint32_t block_zero, uint32_t password) {
+    T5577Plan plan;
+    t5577_plan_clear(&plan);
+    t5577_plan_add_block(&plan, 0, 0, block_zero, false, true, password);
+    return t5577_plan_command_air_time_us(&plan.commands[0]);
+}
+
+static void sim_send(BenchSim* sim, const T5577Recover* recover) {
+    uint32_t block_zero = recover->probe ? BENCH_PROBE_1 : BENCH_PROBE_0;
+    for(uint8_t i = recover->first; i < recover->first + recover->count; i++) {
+        uint32_t candidate = recover->candidates[i];
+        sim->now_us += sim_write_us(block_zero, candidate);
+        if(candidate == sim->password) sim->tag_probe = recover->probe;
+    }
+}
+
+static bool sim_read(BenchSim* sim, uint8_t probe) {
+    sim->now_us += BENCH_READ_SETTLE_US + sim->options->read_ms * 1000.0;
+    if(sim->tag_probe != probe) return false;
+    return sim_random(sim) >= sim->options->miss;
+}
+
+typedef struct {
+    uint32_t found; // The right password was reported
+    uint32_t wrong; // Another one was reported
+    double attempts; // Dictionary candidates sent
+    double search_us; // Time spent sending batches and reading after them
+    double found_us; // Time from the start until the password was known, found trials only
+} BenchResult;
+
+// Runs one tag through the dictionary with this batch size
+static void bench_trial(BenchSim* sim, uint8_t batch, BenchResult* result) {
+    const BenchOptions* options = sim->options;
+    for(uint32_t i = 0; i < options->dictionary; i++) {
+        sim->dictionary[i] = (uint32_t)(sim_next(sim) >> 32);
+    }
+    sim->password = sim->dictionary[sim_next(sim) % options->dictionary];
+    sim->tag_probe = 2;
+    sim->now_us = BENCH_READ_SETTLE_US + options->read_ms * 1000.0; // The baseline read
+
+    T5577Recover recover;
+    t5577_recover_reset(&recover);
+    uint32_t next = 0;
+    double search_start_us = sim->now_us;
+    while(recover.step != T5577RecoverStepFound) {
+        if(recover.step == T5577RecoverStepSearch) {
+            if(next == options->dictionary) break;
+            uint8_t count = 0;
+            while(count < batch && next < options->dictionary) {
+                recover.candidates[count++] = sim->dictionary[next++];
+            }
+            t5577_recover_batch(&recover, count);
+            result->attempts += count;
+            sim_send(sim, &recover);
+            bool took = sim_read(sim, recover.probe);
+            result->search_us += sim->now_us - search_start_us;
+            search_start_us = sim->now_us;
+            t5577_recover_result(&recover, took);
+        } else {
+            sim_send(sim, &recover);
+            t5577_recover_result(&recover, sim_read(sim, recover.probe));
+            search_start_us = sim->now_us;
+        }
+    }
+    if(recover.step != T5577RecoverStepFound) return;
+    if(recover.candidates[recover.first] == sim->password) {
+        result->found++;
+        result->found_us += sim->now_us;
+    } else {
+        result->wrong++;
+    }
+}
+
+// Returns false if a password was missed or a wrong one reported while every read was right
+static bool bench_run(const BenchOptions* options, uint8_t batch) {
+    BenchSim sim = {
+        .options = options,
+        .rng = options->seed,
+        .dictionary = malloc(options->dictionary * sizeof(uint32_t)),
+    };
+    BenchResult result;
+    memset(&result, 0, sizeof(result));
+    for(uint32_t trial = 0; trial < options->trials; trial++) {
+        bench_trial(&sim, batch, &result);
+    }
+    free(sim.dictionary);
+
+    double found = (double)result.found / options->trials;
+    printf(
+        "  batch %2u: %6.1f attempts/s %7.2f%% found %5.2f%% wrong",
+        batch,
+        result.search_us > 0 ? result.attempts * 1e6 / result.search_us : 0.0,
+        found * 100.0,
+        100.0 * result.wrong / options->trials);
+    if(result.found > 0) {
+        printf(" %7.1f s to the password\n", result.found_us / result.found / 1e6);
+    } else {
+        printf(" %7s s to the password\n", "-");
+    }
+    return options->miss > 0 || result.found == options->trials;
+}
+
+static bool bench_option(int argc, char** argv, int* i, const char* name, double* value) {
+    if(strcmp(argv[*i], name) != 0 || *i + 1 >= argc) return false;
+    *value = strtod(argv[++*i], NULL);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options = {
+        BENCH_TRIALS, 0x9E3779B97F4A7C15ULL, BENCH_DICTIONARY, BENCH_READ_MS, 0};
+    for(int i = 1; i < argc; i++) {
+        double value;
+        if(bench_option(argc, argv, &i, "--trials", &value)) {
+            options.trials = value >= 1 ? (uint32_t)value : 1;
+        } else if(bench_option(argc, argv, &i, "--seed", &value)) {
+            options.seed = (uint64_t)value ? (uint64_t)value : 1;
+        } else if(bench_option(argc, argv, &i, "--dictionary", &value)) {
+            options.dictionary = value >= 1 ? (uint32_t)value : 1;
+        } else if(bench_option(argc, argv, &i, "--read-ms", &options.read_ms)) {
+        } else if(bench_option(argc, argv, &i, "--miss", &options.miss)) {
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Without reads, as the screen used to run: every candidate back to back
+    BenchSim blind = {.options = &options, .rng = options.seed};
+    double blind_us = 0;
+    for(uint32_t i = 0; i < options.dictionary; i++) {
+        blind_us += sim_write_us(BENCH_PROBE_0, (uint32_t)(sim_next(&blind) >> 32));
+    }
+    printf(
+        "%u trials, %u candidates, %.0f ms reads, %.1f%% of changes missed\n"
+        "  no reads: %6.1f attempts/s, nothing to tell which password took\n",
+        options.trials,
+        options.dictionary,
+        options.read_ms,
+        options.miss * 100.0,
+        options.dictionary * 1e6 / blind_us);
+
+    static const uint8_t batches[] = {1, 8, 16, T5577_RECOVER_BATCH_SIZE};
+    bool pass = true;
+    for(size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++) {
+        if(!bench_run(&options, batches[b])) pass = false;
+    }
+    if(!pass) printf("A password was missed with every read right\n");
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
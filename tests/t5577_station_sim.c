@@ -0,0 +1,187 @@
+#define _XOPEN_SOURCE 700
+#define _DEFAULT_SOURCE
+
+#include "t5577_station_sim.h"
+
+#include "t5577_config.h"
+#include "t5577_plan.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// The app's current settings, from t5577_writer.c
+#define SIM_REPEAT_WRITES 10 // MAX_REPEAT_WRITING_FRAMES
+#define SIM_READ_MS       250 // REPLY_READ_MS
+#define SIM_BITRATE_MASK  LFRFID_T5577_BITRATE_RF_128 // T5577_WRITER_BITRATE_MASK
+
+#define SIM_PROMPT    "\r\n>: "
+#define SIM_LINE_SIZE 256
+
+struct StationSim {
+    StationSimOptions options;
+    int master;
+    char path[64];
+    pthread_t thread;
+    volatile bool stop;
+    uint64_t rng;
+    int writes;
+};
+
+static double sim_random(StationSim* sim) {
+    // xorshift64*, so a station fails the same way every run
+    sim->rng ^= sim->rng >> 12;
+    sim->rng ^= sim->rng << 25;
+    sim->rng ^= sim->rng >> 27;
+    return ((sim->rng * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void sim_send(StationSim* sim, const char* text) {
+    size_t length = strlen(text);
+    while(length > 0) {
+        ssize_t written = write(sim->master, text, length);
+        if(written <= 0) return;
+        text += written;
+        length -= written;
+    }
+}
+
+static void sim_sleep_us(double us) {
+    struct timespec time = {(time_t)(us / 1e6), (long)((us - (time_t)(us / 1e6) * 1e6) * 1e3)};
+    nanosleep(&time, NULL);
+}
+
+// t5577_writer_cli_write, with the air time of the plan slept instead of sent
+static void sim_write(StationSim* sim, char* args, char* reply, size_t reply_size) {
+    T5577PlanTag tag;
+    memset(&tag, 0, sizeof(tag));
+    uint8_t count = 0;
+    char* save;
+    for(char* word = strtok_r(args, " ", &save); word; word = strtok_r(NULL, " ", &save)) {
+        char* end;
+        uint32_t block = strtoul(word, &end, 16);
+        if(count == LFRFID_T5577_BLOCK_COUNT || strlen(word) != 8 || *end != '\0') {
+            count = 0;
+            break;
+        }
+        if(count == 0) {
+            tag.block_zero = block;
+        } else {
+            tag.content[count] = block;
+        }
+        count++;
+    }
+    if(count == 0) {
+        snprintf(reply, reply_size, "error usage");
+        return;
+    }
+    tag.user_block_num = count - 1;
+    T5577Plan plan;
+    t5577_plan_build(&plan, &tag);
+    double us = (double)plan.air_time_us * SIM_REPEAT_WRITES + SIM_READ_MS * 1000.0;
+    sim_sleep_us(us * sim->options.speed);
+
+    uint8_t c = 0;
+    while(c < CLOCK_NUM &&
+          all_rf_clocks[c].clock_page_zero != (tag.block_zero & SIM_BITRATE_MASK)) {
+        c++;
+    }
+    if(c == CLOCK_NUM || sim_random(sim) < sim->options.fail) {
+        snprintf(reply, reply_size, "error no reply");
+    } else {
+        snprintf(
+            reply, reply_size, "ok RF/%u %.0f ms", all_rf_clocks[c].rf_clock_num, us / 1000.0);
+    }
+}
+
+// A line as the Flipper's CLI gets it: echoed, run, then the output and the prompt
+static bool sim_line(StationSim* sim, char* line) {
+    if(sim->options.die_after >= 0 && sim->writes >= sim->options.die_after) return false;
+    char reply[SIM_LINE_SIZE] = "";
+    char* save;
+    char* command = strtok_r(line, " ", &save);
+    if(command == NULL) {
+        // Just the prompt again
+    } else if(strcmp(command, "t5577") != 0) {
+        snprintf(reply, sizeof(reply), "`%s` command not found", command);
+    } else {
+        char* sub = strtok_r(NULL, " ", &save);
+        if(sub && strcmp(sub, "write") == 0) {
+            sim->writes++;
+            sim_write(sim, save, reply, sizeof(reply));
+        } else {
+            snprintf(reply, sizeof(reply), "error usage");
+        }
+    }
+    sim_send(sim, "\r\n");
+    sim_send(sim, reply);
+    sim_send(sim, SIM_PROMPT);
+    return true;
+}
+
+static void* sim_thread(void* context) {
+    StationSim* sim = context;
+    char line[SIM_LINE_SIZE];
+    size_t length = 0;
+    bool alive = true;
+    while(!sim->stop) {
+        struct pollfd poll_fd = {sim->master, POLLIN, 0};
+        if(poll(&poll_fd, 1, 20) <= 0) continue;
+        char input[64];
+        ssize_t count = read(sim->master, input, sizeof(input));
+        if(count <= 0) {
+            // Nobody has the device open yet, or it was closed again
+            sim_sleep_us(20000);
+            continue;
+        }
+        // A dead station keeps the device open and swallows what it gets, like a hung Flipper
+        for(ssize_t i = 0; alive && i < count; i++) {
+            char c = input[i];
+            if(c == '\r' || c == '\n') {
+                line[length] = '\0';
+                length = 0;
+                alive = sim_line(sim, line);
+            } else if(length + 1 < sizeof(line)) {
+                line[length++] = c;
+                char echo[2] = {c, '\0'};
+                sim_send(sim, echo);
+            }
+        }
+    }
+    return NULL;
+}
+
+StationSim* station_sim_start(const StationSimOptions* options) {
+    StationSim* sim = calloc(1, sizeof(StationSim));
+    sim->options = *options;
+    sim->rng = options->seed ? options->seed : 1;
+    sim->master = posix_openpt(O_RDWR | O_NOCTTY);
+    const char* path = NULL;
+    if(sim->master >= 0 && grantpt(sim->master) == 0 && unlockpt(sim->master) == 0) {
+        path = ptsname(sim->master);
+    }
+    if(path) snprintf(sim->path, sizeof(sim->path), "%s", path);
+    if(path == NULL || pthread_create(&sim->thread, NULL, sim_thread, sim) != 0) {
+        if(sim->master >= 0) close(sim->master);
+        free(sim);
+        return NULL;
+    }
+    return sim;
+}
+
+const char* station_sim_path(const StationSim* sim) {
+    return sim->path;
+}
+
+void station_sim_stop(StationSim* sim) {
+    sim->stop = true;
+    pthread_join(sim->thread, NULL);
+    close(sim->master);
+    free(sim);
+}
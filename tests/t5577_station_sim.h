@@ -0,0 +1,26 @@
+#ifndef T5577_STATION_SIM_H
+#define T5577_STATION_SIM_H
+
+#include <stdint.h>
+
+// A simulated programming station: a pty that answers the app's "t5577" CLI command the way a
+// Flipper with the app open does, so t5577_orchestrator can be run without any hardware.
+
+typedef struct {
+    double speed; // Multiplies the time a write takes, 1 for real time
+    double fail; // Chance a write is answered with "error no reply"
+    int die_after; // Stop answering after this many writes, -1 for never
+    uint64_t seed;
+} StationSimOptions;
+
+typedef struct StationSim StationSim;
+
+// Opens the pty and starts answering on it. Returns NULL if there is no pty to be had.
+StationSim* station_sim_start(const StationSimOptions* options);
+
+// The device to open, like /dev/ttyACM0 for a real Flipper
+const char* station_sim_path(const StationSim* sim);
+
+void station_sim_stop(StationSim* sim);
+
+#endif // T5577_STATION_SIM_H
@@ -0,0 +1,453 @@
+// Write-strategy benchmark: every strategy writes the same plan to a simulated tag over a channel
+// with bit errors, coupling dropouts and a user who takes the tag away, and the chance the tag
+// ends up right, the time it takes and the RF air time are reported.
+//
+// t5577_write_bench [--trials N] [--seed N] [--repeats N] [--ber X] [--flip X] [--dropouts X]
+//                   [--dropout-ms X] [--hold-ms X] [--hold-sd-ms X]
+//
+// Any channel option replaces the built-in profiles with one made of it.
+//
+// The channel model:
+// - Every downlink and uplink bit is wrong with probability ber. A share 'flip' of the errors
+//   keeps the bit count, so the tag programs what it got. The rest adds or loses a gap, and the
+//   tag drops the write.
+// - An error in the opcode or the password always drops the write. One in the address programs
+//   another block with the data.
+// - A write or a read that overlaps a coupling dropout does nothing.
+// - The tag stays in the field for a normally distributed hold time, and the last write to each
+//   block is what it keeps.
+// Lock bits are sent as data and not modelled further. The verify reads are assumed to reach
+// every block: page 0 blocks through the regular read stream, the others through direct reads.
+
+#include "t5577_plan.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The app's current strategy, from t5577_writer.c
+#define BENCH_REPEAT_FRAMES   10 // MAX_REPEAT_WRITING_FRAMES
+#define BENCH_FRAME_PERIOD_US 200000 // repeat_writing_period
+
+#define BENCH_TRIALS         20000
+#define BENCH_READ_SETTLE_US 5000 // Field on and tag reset before a read can start
+#define BENCH_READ_PASSES    2 // A block has to go by twice to be found and checked
+#define BENCH_MAX_RETRIES    BENCH_REPEAT_FRAMES // Per block, for per-block retry
+
+typedef struct {
+    const char* name;
+    double ber; // Per bit, both ways
+    double flip; // Share of bit errors that keep the bit count
+    double dropouts_per_s; // Coupling dropouts per second
+    double dropout_ms; // Mean length of a dropout
+    double hold_ms; // Mean time the tag is held in the field
+    double hold_sd_ms;
+} BenchChannel;
+
+typedef struct {
+    const char* name;
+    T5577PlanTag tag;
+    uint32_t rf_clock; // Cycles per bit of the tag's reply, for the verify reads
+} BenchTag;
+
+typedef struct {
+    const BenchChannel* channel;
+    const T5577Plan* plan;
+    const uint32_t* command_us; // Air time of each command of the plan
+    uint32_t frame_end_us; // The reset that ends a write session
+    uint32_t rf_clock;
+    uint8_t tail_count; // Block 7 with a password, then block 0: always last, in this order
+
+    uint64_t rng;
+    double now_us;
+    double removal_us;
+    double air_us; // Downlink only
+    double drop_start_us; // The next dropout, or the current one
+    double drop_end_us;
+    bool correct[T5577_PLAN_MAX_COMMANDS]; // Block of each command holds what the plan writes
+} BenchSim;
+
+typedef bool (*BenchStrategy)(BenchSim* sim, uint32_t repeats);
+
+static double sim_random(BenchSim* sim) {
+    // xorshift64*, so every run sees the same channel
+    sim->rng ^= sim->rng >> 12;
+    sim->rng ^= sim->rng << 25;
+    sim->rng ^= sim->rng >> 27;
+    return ((sim->rng * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double sim_exponential(BenchSim* sim, double mean) {
+    return -mean * log(1.0 - sim_random(sim));
+}
+
+static double sim_normal(BenchSim* sim) {
+    return sqrt(-2.0 * log(1.0 - sim_random(sim))) * cos(2.0 * M_PI * sim_random(sim));
+}
+
+static void sim_next_dropout(BenchSim* sim) {
+    const BenchChannel* channel = sim->channel;
+    if(channel->dropouts_per_s <= 0) {
+        sim->drop_start_us = INFINITY;
+        sim->drop_end_us = INFINITY;
+        return;
+    }
+    sim->drop_start_us = sim->drop_end_us + sim_exponential(sim, 1e6 / channel->dropouts_per_s);
+    sim->drop_end_us = sim->drop_start_us + sim_exponential(sim, channel->dropout_ms * 1000.0);
+}
+
+static void sim_reset(BenchSim* sim) {
+    sim->now_us = 0;
+    sim->air_us = 0;
+    double hold = sim->channel->hold_ms + sim->channel->hold_sd_ms * sim_normal(sim);
+    sim->removal_us = hold > 0 ? hold * 1000.0 : 0;
+    sim->drop_end_us = 0;
+    sim_next_dropout(sim);
+    memset(sim->correct, 0, sizeof(sim->correct));
+}
+
+// True if the tag stays coupled from now for this long. Time only moves forward.
+static bool sim_coupled(BenchSim* sim, double duration_us) {
+    while(sim->drop_end_us <= sim->now_us) {
+        sim_next_dropout(sim);
+    }
+    return sim->drop_start_us >= sim->now_us + duration_us;
+}
+
+static bool sim_bits_clean(BenchSim* sim, uint32_t count) {
+    return sim_random(sim) < pow(1.0 - sim->channel->ber, count);
+}
+
+// Takes duration_us of field time. Returns false if the tag is gone before it's over.
+static bool sim_take(BenchSim* sim, double duration_us) {
+    if(sim->now_us + duration_us > sim->removal_us) {
+        sim->now_us = sim->removal_us;
+        return false;
+    }
+    sim->now_us += duration_us;
+    return true;
+}
+
+static bool sim_all_correct(const BenchSim* sim) {
+    for(uint8_t c = 0; c < sim->plan->command_count; c++) {
+        if(!sim->correct[c]) return false;
+    }
+    return true;
+}
+
+static bool sim_write(BenchSim* sim, uint8_t c) {
+    uint32_t duration = sim->command_us[c];
+    bool coupled = sim_coupled(sim, duration);
+    if(!sim_take(sim, duration)) return false;
+    sim->air_us += duration;
+    if(!coupled) return true;
+
+    uint8_t bit_count = sim->plan->commands[c].bit_count;
+    bool header_clean = sim_bits_clean(sim, bit_count - 36); // Opcode, then the password
+    bool data_clean = sim_bits_clean(sim, 33); // Lock, then data
+    bool address_clean = sim_bits_clean(sim, 3);
+    if(!header_clean) return true;
+    if(!data_clean && sim_random(sim) >= sim->channel->flip) return true;
+    if(!address_clean && sim_random(sim) >= sim->channel->flip) return true;
+    if(address_clean) {
+        sim->correct[c] = data_clean;
+    } else if(sim->plan->command_count > 1) {
+        // Some other block of the plan gets this one's data
+        uint8_t other = (c + 1 + (uint8_t)(sim_random(sim) * (sim->plan->command_count - 1))) %
+                        sim->plan->command_count;
+        sim->correct[other] = false;
+    }
+    return true;
+}
+
+// One write session with the given order. Returns false if the tag is gone.
+static bool sim_frame(BenchSim* sim, const uint8_t* order) {
+    for(uint8_t i = 0; i < sim->plan->command_count; i++) {
+        if(!sim_write(sim, order[i])) return false;
+    }
+    if(!sim_take(sim, sim->frame_end_us)) return false;
+    sim->air_us += sim->frame_end_us;
+    return true;
+}
+
+// Read back the blocks of these commands. Returns true if they were read and all are right.
+static bool sim_verify(BenchSim* sim, uint8_t first, uint8_t count, bool* gone) {
+    uint32_t bits = BENCH_READ_PASSES * 32 * count;
+    double duration = BENCH_READ_SETTLE_US +
+                      (double)bits * sim->rf_clock * T5577_PLAN_RF_CYCLE_US;
+    bool coupled = sim_coupled(sim, duration);
+    *gone = !sim_take(sim, duration);
+    if(*gone || !coupled || !sim_bits_clean(sim, bits)) return false;
+    for(uint8_t c = first; c < first + count; c++) {
+        if(!sim->correct[c]) return false;
+    }
+    return true;
+}
+
+static void order_plan(const BenchSim* sim, uint8_t* order) {
+    for(uint8_t i = 0; i < sim->plan->command_count && i < T5577_PLAN_MAX_COMMANDS; i++) {
+        order[i] = i;
+    }
+}
+
+// What the app does now: the whole plan every frame period, repeats times, never looking back
+static bool strategy_blind(BenchSim* sim, uint32_t repeats) {
+    uint8_t order[T5577_PLAN_MAX_COMMANDS];
+    order_plan(sim, order);
+    for(uint32_t frame = 0; frame < repeats; frame++) {
+        double start = (double)frame * BENCH_FRAME_PERIOD_US;
+        if(start > sim->now_us && !sim_take(sim, start - sim->now_us)) break;
+        if(!sim_frame(sim, order)) break;
+    }
+    return sim_all_correct(sim);
+}
+
+// Blind repeats, but each frame starts the other blocks one further on, so a frame cut short by
+// the tag leaving doesn't always miss the same ones. The password and block 0 stay last.
+static bool strategy_rotate(BenchSim* sim, uint32_t repeats) {
+    uint8_t count = sim->plan->command_count;
+    uint8_t head_count = count - sim->tail_count;
+    uint8_t order[T5577_PLAN_MAX_COMMANDS];
+    order_plan(sim, order);
+    for(uint32_t frame = 0; frame < repeats; frame++) {
+        for(uint8_t i = 0; i < head_count; i++) {
+            order[i] = (i + frame) % head_count;
+        }
+        double start = (double)frame * BENCH_FRAME_PERIOD_US;
+        if(start > sim->now_us && !sim_take(sim, start - sim->now_us)) break;
+        if(!sim_frame(sim, order)) break;
+    }
+    return sim_all_correct(sim);
+}
+
+// The whole plan, then a read of every block, until it reads back right
+static bool strategy_verify(BenchSim* sim, uint32_t repeats) {
+    uint8_t order[T5577_PLAN_MAX_COMMANDS];
+    order_plan(sim, order);
+    for(uint32_t frame = 0; frame < repeats; frame++) {
+        if(!sim_frame(sim, order)) break;
+        bool gone;
+        if(sim_verify(sim, 0, sim->plan->command_count, &gone) || gone) break;
+    }
+    return sim_all_correct(sim);
+}
+
+// Each block is written and read back on its own until it's right, then the next one
+static bool strategy_per_block(BenchSim* sim, uint32_t repeats) {
+    (void)repeats; // Retries are per block
+    for(uint8_t c = 0; c < sim->plan->command_count; c++) {
+        for(uint32_t retry = 0; retry < BENCH_MAX_RETRIES; retry++) {
+            if(!sim_write(sim, c)) return sim_all_correct(sim);
+            bool gone;
+            if(sim_verify(sim, c, 1, &gone)) break;
+            if(gone) return sim_all_correct(sim);
+        }
+    }
+    if(sim_take(sim, sim->frame_end_us)) sim->air_us += sim->frame_end_us;
+    return sim_all_correct(sim);
+}
+
+// Bursts of 1, 2, 4... frames at the frame period with a read of every block after each, so a
+// bad channel pays for fewer reads. Stops at the repeat count.
+static bool strategy_adaptive(BenchSim* sim, uint32_t repeats) {
+    uint8_t order[T5577_PLAN_MAX_COMMANDS];
+    order_plan(sim, order);
+    uint32_t frame = 0;
+    for(uint32_t burst = 1; frame < repeats; burst *= 2) {
+        double burst_start = sim->now_us;
+        for(uint32_t i = 0; i < burst && frame < repeats; i++, frame++) {
+            double start = burst_start + (double)i * BENCH_FRAME_PERIOD_US;
+            if(start > sim->now_us && !sim_take(sim, start - sim->now_us)) {
+                return sim_all_correct(sim);
+            }
+            if(!sim_frame(sim, order)) return sim_all_correct(sim);
+        }
+        bool gone;
+        if(sim_verify(sim, 0, sim->plan->command_count, &gone) || gone) break;
+    }
+    return sim_all_correct(sim);
+}
+
+typedef struct {
+    const char* name;
+    BenchStrategy run;
+} BenchStrategyEntry;
+
+static const BenchStrategyEntry strategies[] = {
+    {"blind", strategy_blind},
+    {"rotate", strategy_rotate},
+    {"verify", strategy_verify},
+    {"per-block", strategy_per_block},
+    {"adaptive", strategy_adaptive},
+};
+
+// Ideal first: every strategy has to get every tag right on it, which is the self-check
+static const BenchChannel profiles[] = {
+    {"ideal", 0, 0.5, 0, 0, 1e9, 0},
+    {"bench", 1e-4, 0.5, 0.2, 50, 3000, 1000},
+    {"noisy", 2e-3, 0.5, 0.2, 50, 3000, 1000},
+    {"weak coupling", 5e-4, 0.5, 3, 100, 3000, 1000},
+    {"hurried", 1e-4, 0.5, 0.2, 50, 1200, 400},
+};
+
+static const BenchTag tags[] = {
+    {
+        "EM4100",
+        {
+            .block_zero = LFRFID_T5577_MODULATION_MANCHESTER | LFRFID_T5577_BITRATE_RF_64 |
+                          (2 << LFRFID_T5577_MAXBLOCK_SHIFT),
+            .content = {0, 0xFF8C6318u, 0xC6314B2Au},
+            .user_block_num = 2,
+        },
+        64,
+    },
+    {
+        "Full",
+        {
+            .block_zero = LFRFID_T5577_MODULATION_MANCHESTER | LFRFID_T5577_BITRATE_RF_32 |
+                          LFRFID_T5577_PWD | (6 << LFRFID_T5577_MAXBLOCK_SHIFT),
+            .content = {0, 1, 2, 3, 4, 5, 6, 7},
+            .user_block_num = 7,
+            .page_1 = {0, 0x11u, 0x12u, 0x13u},
+            .write_page_1 = true,
+            .use_password = true,
+            .password = 0x51243648u,
+        },
+        32,
+    },
+};
+
+typedef struct {
+    uint32_t trials;
+    uint64_t seed;
+    uint32_t repeats;
+} BenchOptions;
+
+// Returns false if the strategy got a tag wrong on the ideal channel
+static bool
+    bench_run(const BenchOptions* options, const BenchChannel* channel, const BenchTag* tag) {
+    T5577Plan plan;
+    t5577_plan_build(&plan, &tag->tag);
+    uint32_t command_us[T5577_PLAN_MAX_COMMANDS];
+    uint32_t commands_us = 0;
+    for(uint8_t c = 0; c < plan.command_count; c++) {
+        command_us[c] = t5577_plan_command_air_time_us(&plan.commands[c]);
+        commands_us += command_us[c];
+    }
+    printf(
+        "  %s: %u writes, %.1f ms air time per frame\n",
+        tag->name,
+        plan.command_count,
+        plan.air_time_us / 1000.0);
+
+    bool pass = true;
+    for(size_t s = 0; s < sizeof(strategies) / sizeof(strategies[0]); s++) {
+        BenchSim sim = {
+            .channel = channel,
+            .plan = &plan,
+            .command_us = command_us,
+            .frame_end_us = plan.air_time_us - commands_us,
+            .rf_clock = tag->rf_clock,
+            .tail_count = tag->tag.use_password ? 2 : 1,
+            .rng = options->seed,
+        };
+        uint32_t successes = 0;
+        double time_us = 0;
+        double air_us = 0;
+        for(uint32_t trial = 0; trial < options->trials; trial++) {
+            sim_reset(&sim);
+            if(strategies[s].run(&sim, options->repeats)) successes++;
+            time_us += sim.now_us;
+            air_us += sim.air_us;
+        }
+        double success = (double)successes / options->trials;
+        double time_ms = time_us / options->trials / 1000.0;
+        if(success > 0) {
+            printf(
+                "    %-10s %7.2f%% %8.0f ms per try %8.0f ms per good tag %7.1f ms air\n",
+                strategies[s].name,
+                success * 100.0,
+                time_ms,
+                time_ms / success,
+                air_us / options->trials / 1000.0);
+        } else {
+            printf(
+                "    %-10s %7.2f%% %8.0f ms per try %8s ms per good tag %7.1f ms air\n",
+                strategies[s].name,
+                0.0,
+                time_ms,
+                "-",
+                air_us / options->trials / 1000.0);
+        }
+        if(channel->ber == 0 && channel->dropouts_per_s == 0 && successes != options->trials) {
+            pass = false;
+        }
+    }
+    return pass;
+}
+
+static bool bench_option(int argc, char** argv, int* i, const char* name, double* value) {
+    if(strcmp(argv[*i], name) != 0 || *i + 1 >= argc) return false;
+    *value = strtod(argv[++*i], NULL);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options = {BENCH_TRIALS, 0x9E3779B97F4A7C15ULL, BENCH_REPEAT_FRAMES};
+    BenchChannel custom = profiles[1];
+    custom.name = "custom";
+    bool use_custom = false;
+    for(int i = 1; i < argc; i++) {
+        double value;
+        if(bench_option(argc, argv, &i, "--trials", &value)) {
+            options.trials = value >= 1 ? (uint32_t)value : 1;
+        } else if(bench_option(argc, argv, &i, "--seed", &value)) {
+            options.seed = (uint64_t)value ? (uint64_t)value : 1;
+        } else if(bench_option(argc, argv, &i, "--repeats", &value)) {
+            options.repeats = value >= 1 ? (uint32_t)value : 1;
+        } else if(bench_option(argc, argv, &i, "--ber", &custom.ber)) {
+            use_custom = true;
+        } else if(bench_option(argc, argv, &i, "--flip", &custom.flip)) {
+            use_custom = true;
+        } else if(bench_option(argc, argv, &i, "--dropouts", &custom.dropouts_per_s)) {
+            use_custom = true;
+        } else if(bench_option(argc, argv, &i, "--dropout-ms", &custom.dropout_ms)) {
+            use_custom = true;
+        } else if(bench_option(argc, argv, &i, "--hold-ms", &custom.hold_ms)) {
+            use_custom = true;
+        } else if(bench_option(argc, argv, &i, "--hold-sd-ms", &custom.hold_sd_ms)) {
+            use_custom = true;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    const BenchChannel* channels = use_custom ? &custom : profiles;
+    size_t channel_count = use_custom ? 1 : sizeof(profiles) / sizeof(profiles[0]);
+    printf(
+        "%u trials, %u frames %u ms apart for the repeating strategies\n\n",
+        options.trials,
+        options.repeats,
+        BENCH_FRAME_PERIOD_US / 1000);
+    bool pass = true;
+    for(size_t c = 0; c < channel_count; c++) {
+        const BenchChannel* channel = &channels[c];
+        printf(
+            "%s: ber %g, %.0f%% kept, %.1f dropouts/s of %.0f ms, held %.0f +-%.0f ms\n",
+            channel->name,
+            channel->ber,
+            channel->flip * 100.0,
+            channel->dropouts_per_s,
+            channel->dropout_ms,
+            channel->hold_ms,
+            channel->hold_sd_ms);
+        for(size_t t = 0; t < sizeof(tags) / sizeof(tags[0]); t++) {
+            if(!bench_run(&options, channel, &tags[t])) pass = false;
+        }
+        printf("\n");
+    }
+    if(!pass) printf("A strategy failed on an ideal channel\n");
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}